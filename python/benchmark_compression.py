@@ -0,0 +1,70 @@
+import re
+import subprocess
+import sys
+
+# Compares clique counting with plain and with compressed (delta + varint)
+# oriented adjacency lists (the -c flag of degeneracy_cliques).
+#
+# Usage: benchmark_compression.py <degeneracy_cliques> <graph> [type] [max_k] [runs] [format]
+# eg.: python benchmark_compression.py ../bin/degeneracy_cliques ../graphs/email-Enron.edges A 0 3
+#
+# Each setting is run [runs] times (default 3) and the fastest time is kept.
+# Throughput is the number of edges divided by the time degeneracy_cliques
+# reports, which covers ordering, compression and counting.
+
+
+def run(binary, graph, ctype, max_k, fmt, compress):
+    args = [binary, '-i', graph, '-t', ctype, '-k', str(max_k), '-d', '0',
+            '-o', '1', '-f', fmt, '-c', str(compress)]
+    out = subprocess.check_output(args).decode()
+    lines = out.split('\n')
+
+    seconds = None
+    for i in range(len(lines)):
+        if lines[i].startswith('time,'):
+            seconds = float(lines[i+1].split(',')[0])
+
+    packed = re.search(r'Compressed oriented adjacency to (\d+) bytes from (\d+)', out)
+    counts = [l for l in lines if re.match(r'^\d+, ', l)]
+    return seconds, packed, counts
+
+
+if len(sys.argv) < 3:
+    print('Usage: python benchmark_compression.py <degeneracy_cliques> <graph> [type] [max_k] [runs] [format]')
+    sys.exit(1)
+
+binary = sys.argv[1]
+graph = sys.argv[2]
+ctype = sys.argv[3] if len(sys.argv) > 3 else 'A'
+max_k = int(sys.argv[4]) if len(sys.argv) > 4 else 0
+runs = int(sys.argv[5]) if len(sys.argv) > 5 else 3
+fmt = sys.argv[6] if len(sys.argv) > 6 else 'edges'
+
+best = {}
+packed = None
+counts = {}
+for compress in [0, 1]:
+    for r in range(runs):
+        seconds, p, c = run(binary, graph, ctype, max_k, fmt, compress)
+        if p is not None:
+            packed = p
+        counts[compress] = c
+        if compress not in best or seconds < best[compress]:
+            best[compress] = seconds
+
+plainBytes = int(packed.group(2))
+packedBytes = int(packed.group(1))
+m = plainBytes // 8
+
+print('adjacency,bytes,seconds,edges_per_second')
+for compress in [0, 1]:
+    size = packedBytes if compress else plainBytes
+    rate = m / best[compress] if best[compress] > 0 else float('inf')
+    print('%s,%d,%f,%f' % ('compressed' if compress else 'plain', size, best[compress], rate))
+
+print('')
+print('memory ratio: %f' % (float(packedBytes) / plainBytes))
+if best[0] > 0:
+    print('time ratio: %f' % (best[1] / best[0]))
+if counts[0] != counts[1]:
+    print('WARNING: clique counts differ between the two runs')
@@ -0,0 +1,107 @@
+import os
+import random
+import shutil
+import subprocess
+import sys
+import tempfile
+
+# Checks that the vectorized set kernels (the -simd flag of
+# degeneracy_cliques) count exactly what the scalar ones count.
+#
+# Usage: check_set_kernels.py <degeneracy_cliques> [graph] [format]
+# eg.: python check_set_kernels.py ../bin/degeneracy_cliques
+#      python check_set_kernels.py ../bin/degeneracy_cliques ../graphs/email-Enron.edges
+#
+# Without a graph a random one is generated: dense communities, so that
+# neighbor lists are long enough for the vector loops and their tails, on
+# top of a sparse background. A, V and E are run with every kernel this CPU
+# supports, on arrays (-b 0) and with the default bitsets, and the total,
+# per-vertex and per-edge counts (and for A the size of the recursion) are
+# compared with those of -simd scalar. Exits with 1 if any differ.
+
+
+def writeRandomGraph(path, n=3000, seed=1):
+    rng = random.Random(seed)
+    edges = set()
+
+    v = 0
+    while v < n:
+        size = rng.randint(20, 80)
+        members = range(v, min(n, v + size))
+        p = rng.uniform(0.3, 0.7)
+        for i in members:
+            for j in members:
+                if i < j and rng.random() < p:
+                    edges.add((i, j))
+        v += size
+
+    for e in range(4*n):
+        i, j = rng.randrange(n), rng.randrange(n)
+        if i != j:
+            edges.add((min(i, j), max(i, j)))
+
+    with open(path, 'w') as f:
+        f.write('%d %d\n' % (n, len(edges)))
+        for (i, j) in sorted(edges):
+            f.write('%d %d\n' % (i, j))
+
+
+def run(binary, graph, fmt, ctype, kernels, bits, workdir):
+    results = os.path.join(workdir, 'results')
+    shutil.rmtree(results, ignore_errors=True)
+    os.mkdir(results)
+
+    args = [binary, '-i', graph, '-t', ctype, '-k', '0', '-d', '1', '-o', '0',
+            '-f', fmt, '-simd', kernels]
+    if bits is not None:
+        args += ['-b', str(bits)]
+    out = subprocess.check_output(args, cwd=workdir, stderr=subprocess.STDOUT).decode()
+
+    used = None
+    for line in out.split('\n'):
+        if line.startswith('Using the '):
+            used = line.split()[2]
+
+    # the counts file, without the time each run took
+    counts = []
+    for name in sorted(os.listdir(results)):
+        lines = open(os.path.join(results, name)).read().split('\n')
+        for i in range(len(lines)):
+            if i > 0 and lines[i-1].startswith('time,'):
+                counts.append(lines[i].split(',', 1)[1])
+            else:
+                counts.append(lines[i])
+
+    return used, counts
+
+
+if len(sys.argv) < 2:
+    print('Usage: python check_set_kernels.py <degeneracy_cliques> [graph] [format]')
+    sys.exit(1)
+
+binary = os.path.abspath(sys.argv[1])
+workdir = tempfile.mkdtemp()
+if len(sys.argv) > 2:
+    graph = os.path.abspath(sys.argv[2])
+else:
+    graph = os.path.join(workdir, 'random.edges')
+    writeRandomGraph(graph)
+fmt = sys.argv[3] if len(sys.argv) > 3 else 'edges'
+
+failed = 0
+for ctype in ['A', 'V', 'E']:
+    for bits in [0, None]:
+        setting = '%s %s' % (ctype, 'arrays' if bits == 0 else 'bitsets')
+        used, expected = run(binary, graph, fmt, ctype, 'scalar', bits, workdir)
+        for kernels in ['avx2', 'avx512']:
+            used, counts = run(binary, graph, fmt, ctype, kernels, bits, workdir)
+            if used != kernels:
+                print('%s %s: not supported by this CPU, skipped' % (setting, kernels))
+            elif counts != expected:
+                print('%s %s: FAILED, the counts differ from scalar' % (setting, kernels))
+                failed = 1
+            else:
+                print('%s %s: ok' % (setting, kernels))
+
+shutil.rmtree(workdir, ignore_errors=True)
+sys.exit(failed)
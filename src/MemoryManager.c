@@ -32,5 +32,6 @@
 
 #ifdef MEMORY_DEBUG
 
+long numAllocations = 0;
 
 #endif
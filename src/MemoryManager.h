@@ -35,6 +35,12 @@
 #ifdef MEMORY_DEBUG
 #include<stdio.h>
 
+// the number of calls to Malloc, Calloc and Realloc so far, from all threads
+extern long numAllocations;
+
+// this file may be included before misc.h defines max
+#define MEMORY_MAX(x,y) ((x) > (y) ? (x) : (y))
+
 /*! \brief Call malloc and ensure that it returns non-NULL.
 
     \param x, the number of bytes to allocate
@@ -45,10 +51,12 @@
 
 static void* MallocWithCheck(size_t x)
 {
+    __atomic_fetch_add(&numAllocations, 1, __ATOMIC_RELAXED);
+
     #ifdef ALLOW_ALLOC_ZERO_BYTES
     void* retvalue = malloc(x);
     #else
-    void* retvalue = malloc(max(x,1));
+    void* retvalue = malloc(MEMORY_MAX(x,1));
     #endif
 
     if(retvalue==NULL)
@@ -72,10 +80,12 @@ static void* MallocWithCheck(size_t x)
 
 static void* CallocWithCheck(size_t x, size_t y)
 {
+    __atomic_fetch_add(&numAllocations, 1, __ATOMIC_RELAXED);
+
     #ifdef ALLOW_ALLOC_ZERO_BYTES
     void* retvalue = calloc(x,y); 
     #else
-    void* retvalue = calloc(max(x,1),max(y,1)); 
+    void* retvalue = calloc(MEMORY_MAX(x,1),MEMORY_MAX(y,1)); 
     #endif
 
     if(retvalue==NULL)
@@ -87,8 +97,34 @@ static void* CallocWithCheck(size_t x, size_t y)
     return retvalue;
 };
 
+/*! \brief Call realloc, and ensure that it returns non-NULL.
+
+    \param x, the memory to resize
+
+    \param y, the new size in bytes
+
+    \return a pointer to the resized memory. If it is null, exit the program with error.
+
+*/
+
+static void* ReallocWithCheck(void* x, size_t y)
+{
+    __atomic_fetch_add(&numAllocations, 1, __ATOMIC_RELAXED);
+
+    void* retvalue = realloc(x, MEMORY_MAX(y,1));
+
+    if(retvalue==NULL)
+    {
+        fprintf(stderr, "ERROR, realloc returned null pointer, that means we probably ran out of memory...\n");
+        exit(1);
+    }
+
+    return retvalue;
+};
+
 #define Malloc(x) MallocWithCheck(x)
 #define Calloc(x,y) CallocWithCheck(x,y)
+#define Realloc(x,y) ReallocWithCheck(x,y)
 #define Free(x) free(x)
 
 #else
@@ -96,12 +132,14 @@ static void* CallocWithCheck(size_t x, size_t y)
     #ifdef ALLOW_ALLOC_ZERO_BYTES
     #define Malloc(x) malloc(x)
     #define Calloc(x,y) calloc(x,y)
+    #define Realloc(x,y) realloc(x,y)
     #define Free(x) free(x)
 
     #else
 
     #define Malloc(x) malloc(max(x,1))
     #define Calloc(x,y) calloc(max(x,1),max(y,1))
+    #define Realloc(x,y) realloc(x,max(y,1))
     #define Free(x) free(x)
 
     #endif // ALLOW_ALLOC_ZERO_BYTES
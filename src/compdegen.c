@@ -16,14 +16,19 @@
 #include<assert.h>
 #include<stdio.h>
 #include<stdlib.h>
+#include<string.h>
+#include<unistd.h>
 
 #include"misc.h"
 #include"LinkedList.h"
 #include"MemoryManager.h"
+#include"degeneracy_helper.h"
+#include"graph_ingest.h"
 
 /*! \file compdegen.c
 
-   \brief print the degeneracy of the input graph
+   \brief compute the core number of every vertex of the input graph,
+           and print the degeneracy and the sizes of the k-cores
 
     \author Darren Strash (first name DOT last name AT gmail DOT com)
 
@@ -39,25 +44,167 @@
 */
 
 
-int main()
+/*! \brief write the core numbers to a file, as n raw 32-bit integers in
+           vertex order (binary) or as one "vertex,core" line per vertex
+           (text).
+
+    \param path the path of the file
+
+    \param core the core number of each vertex
+
+    \param n the number of vertices
+
+    \param binary 1 for the binary format, 0 for text
+
+    \return 1 on success, 0 if the file could not be written.
+*/
+
+static int writeCoreNumbers(const char* path, int* core, int n, int binary)
 {
+    FILE* fp = fopen(path, binary ? "wb" : "w");
+    int ok = (fp != NULL);
+    int i = 0;
 
-    int n; // number of vertices
-    int m; // 2x number of edges
+    if (!ok) return 0;
 
-    LinkedList** adjacencyList = readInGraphAdjList(&n,&m);
+    if (binary)
+        ok = (fwrite(core, sizeof(int), n, fp) == (size_t)n);
+    else
+    {
+        for (i = 0; i < n && ok; i++)
+            ok = (fprintf(fp, "%d,%d\n", i, core[i]) > 0);
+    }
 
-    int d = computeDegeneracy(adjacencyList, n);
+    if (fclose(fp) != 0) ok = 0;
 
+    return ok;
+}
+
+/*! \brief write the core size histogram: for every k up to the degeneracy,
+           the number of vertices with core number k and the number of
+           vertices in the k-core (core number at least k).
+
+    \param fp the file to write to
+
+    \param core the core number of each vertex
+
+    \param n the number of vertices
+
+    \param degeneracy the largest core number
+*/
+
+static void printCoreHistogram(FILE* fp, int* core, int n, int degeneracy)
+{
+    long* numWithCore = (long*) Calloc(degeneracy + 1, sizeof(long));
+    long coreSize = n;
     int i = 0;
+    int k = 0;
+
+    for (i = 0; i < n; i++)
+        numWithCore[core[i]]++;
+
+    fprintf(fp, "k,core number k,k-core size\n");
+    for (k = 0; k <= degeneracy; k++)
+    {
+        fprintf(fp, "%d,%ld,%ld\n", k, numWithCore[k], coreSize);
+        coreSize -= numWithCore[k];
+    }
+
+    Free(numWithCore);
+}
+
+int main(int argc, char** argv)
+{
+    int opt;
+    char *fpath = NULL;
+    int format = FORMAT_EDGES;
+    char *binaryOut = NULL;
+    char *textOut = NULL;
+    char *histogramOut = NULL;
+
+    while((opt = getopt(argc, argv, ":i:f:b:x:s:")) != -1)
+    {
+        switch(opt)
+        {
+            case 'i':
+                fpath = optarg;
+                break;
+            case 'f':
+                format = parseGraphFormat(optarg);
+                if (format < 0)
+                {
+                    printf("Incorrect format. Format should be edges, snap, csv, mtx or metis.\n");
+                    return 0;
+                }
+                break;
+            case 'b':
+                binaryOut = optarg;
+                break;
+            case 'x':
+                textOut = optarg;
+                break;
+            case 's':
+                histogramOut = optarg;
+                break;
+            default:
+                printf("./compdegen [-i <file_path>] [-f <format>] [-b <core_file>] [-x <core_file>] [-s <histogram_file>]\n");
+                printf("file_path: path to file, or a directory or quoted glob pattern of shards. Without it the graph is read from stdin as \"n\", \"2m\" and \"u,v\" lines.\n");
+                printf("format: edges (default), snap, csv, mtx or metis.\n");
+                printf("core_file: -b writes the core numbers as n raw 32-bit integers, -x as \"vertex,core\" text lines.\n");
+                printf("histogram_file: where to write the number of vertices with each core number and the k-core sizes, instead of stdout.\n");
+                return 0;
+        }
+    }
+
+    CSRGraph* graph = NULL;
+
+    if (fpath != NULL)
+        graph = loadGraphCSR(fpath, format);
+    else
+    {
+        int n; // number of vertices
+        int m; // 2x number of edges
+        int i = 0;
+
+        LinkedList** adjacencyList = readInGraphAdjList(&n,&m);
+
+        graph = csrFromAdjList(adjacencyList, n);
+
+        while(i<n)
+        {
+            destroyLinkedList(adjacencyList[i]);
+            i++;
+        }
+
+        Free(adjacencyList);
+    }
+
+    int* core = (int*) Calloc(max(graph->n, 1), sizeof(int));
+
+    int d = computeCoreNumbers(graph, core);
+
+    if ((binaryOut != NULL) && !writeCoreNumbers(binaryOut, core, graph->n, 1))
+        fprintf(stderr, "Could not write the core numbers to %s.\n", binaryOut);
+
+    if ((textOut != NULL) && !writeCoreNumbers(textOut, core, graph->n, 0))
+        fprintf(stderr, "Could not write the core numbers to %s.\n", textOut);
 
-    while(i<n)
+    if (histogramOut != NULL)
     {
-        destroyLinkedList(adjacencyList[i]);
-        i++;
+        FILE* fp = fopen(histogramOut, "w");
+        if (fp == NULL)
+            fprintf(stderr, "Could not write the core histogram to %s.\n", histogramOut);
+        else
+        {
+            printCoreHistogram(fp, core, graph->n, d);
+            fclose(fp);
+        }
     }
+    else
+        printCoreHistogram(stdout, core, graph->n, d);
 
-    Free(adjacencyList); 
+    Free(core);
+    destroyCSRGraph(graph);
 
     fprintf(stderr, "Degeneracy is %d\n", d);
     return 0;
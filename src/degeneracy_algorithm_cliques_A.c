@@ -30,6 +30,7 @@
 #include<assert.h>
 #include<stdio.h>
 #include<stdlib.h>
+#include<time.h>
 
 
 #include"misc.h"
@@ -38,220 +39,387 @@
 #include"degeneracy_helper.h"
 #include"degeneracy_algorithm_cliques_A.h"
 
-extern double nCr[1001][401];
+// the calls sampleRecursionCost_A runs between checks of its budget
+#define SAMPLE_SLICE_CALLS 4096
 
 
-void listAllCliquesDegeneracy_A(double * cliqueCounts, NeighborListArray** orderingArray, 
-                                      int size, int max_k, double *nCalls, double *sumP, double *sqP,int flag_o)
+
+/*! \brief add the cliques a leaf of the recursion stands for on a graph
+           of twin classes: every kept class gives a nonempty subset of its
+           vertices and every dropped class any subset.
+
+    \param cliqueCounts the number of k-cliques, for each k
+
+    \param keepV the kept vertices
+
+    \param keep the number of kept vertices
+
+    \param dropV the dropped vertices
+
+    \param drop the number of dropped vertices
+
+    \param twins the weights and scratch space
+
+    \param min_k the smallest clique size to count
+
+    \param max_k the largest clique size to count
+*/
+
+static void addTwinCliques_A(count_t* cliqueCounts, int* keepV, int keep, int* dropV, int drop,
+                             TwinWeights* twins, int min_k, int max_k)
 {
-    *nCalls = (*nCalls) + 1;
+    int dropWeight = 0;
+    for (int j = 0; j < drop; j++)
+        dropWeight += twins->weight[dropV[j]];
+
+    int lowest = twinKeepPolynomial(twins->keepPoly, keepV, keep, -1, -1, twins->weight, max_k);
+
+    for (int k = max(lowest, min_k); k <= max_k; k++)
+        cliqueCounts[k - min_k] += twinBinomialSum(twins->keepPoly, lowest, dropWeight, k);
+}
+
+/*! \brief add the cliques a leaf of the recursion stands for: R with any
+           subset of the dropped (pivot) vertices.
+
+    \param cliqueCounts the number of k-cliques, for each k from min_k to max_k
+
+    \param rsize the number of vertices in R
 
-    // vertex sets are stored in an array like this:
-    // |--X--|--P--|
-    int* vertexSets = (int *)Calloc(size, sizeof(int));
+    \param drop the number of pivots among them
 
-    // vertex i is stored in vertexSets[vertexLookup[i]]
-    int* vertexLookup = (int *)Calloc(size, sizeof(int));
+    \param keepV the kept vertices, only filled in if twins is not NULL
 
-    int** neighborsInP = (int **)Calloc(size, sizeof(int*));
-    int* numNeighbors = (int *)Calloc(size, sizeof(int));
-   
-    int i = 0;
+    \param dropV the dropped vertices, only filled in if twins is not NULL
 
-    while(i<size)
+    \param twins the weights and scratch space, or NULL
+
+    \param min_k the smallest clique size to count
+
+    \param max_k the largest clique size to count
+*/
+
+static void addCliques_A(count_t* cliqueCounts, int rsize, int drop, int* keepV, int* dropV,
+                         TwinWeights* twins, int min_k, int max_k)
+{
+    if (twins != NULL)
     {
-        vertexLookup[i] = i;
-        vertexSets[i] = i;
-        neighborsInP[i] = (int *)Calloc(1, sizeof(int));
-        numNeighbors[i] = 1;
-        i++;
+        addTwinCliques_A(cliqueCounts, keepV, rsize-drop, dropV, drop, twins, min_k, max_k);
+        return;
     }
 
-    int beginX = 0;
-    int beginP = 0;
-    int beginR = size;
-
-    // for each vertex
-    for(i=0;i<size;i++)
+    for (int i=min(drop, rsize-min_k); (i>=0) && (rsize-i <= max_k); i--) 
     {
-        int vertex = (int)orderingArray[i]->vertex;
-        
-        int newBeginX, newBeginP, newBeginR;
+        int k = rsize - i;
+        cliqueCounts[k - min_k] += nCr[drop][i];
+    }
+}
 
-        // set P to be later neighbors and X to be be earlier neighbors
-        // of vertex
-        fillInPandXForRecursiveCallDegeneracyCliques( i, vertex, 
-                                               vertexSets, vertexLookup, 
-                                               orderingArray,
-                                               neighborsInP, numNeighbors,
-                                               &beginX, &beginP, &beginR, 
-                                               &newBeginX, &newBeginP, &newBeginR);
+static void listAllCliquesBitsetRecursive_A(count_t* cliqueCounts, BitsetGraph* bitset, const uint64_t* setP,
+                                            int min_k, int max_k, double *nCalls, double *sumP, double *sqP,
+                                            int rsize, int drop, int* keepV, int* dropV, TwinWeights* twins);
 
-        *sumP = *sumP + (newBeginR - newBeginP);
-        *sqP = *sqP + ((newBeginR - newBeginP)*(newBeginR - newBeginP));
+/*! \brief branch on the candidates of a call whose P is a bitset: the
+           vertices of P that are not neighbors of the pivot. Each one is
+           added to R with P cut down to its neighbors, and then leaves P.
 
-        // recursively compute maximal cliques containing vertex, some of its
-        // later neighbors, and avoiding earlier neighbors
-        int drop = 0;
-        int rsize = 1;
+    \param cliqueCounts the number of k-cliques, for each k from min_k to max_k
 
-        listAllCliquesDegeneracyRecursive_A(cliqueCounts, 
-                                                  vertexSets, vertexLookup,
-                                                  neighborsInP, numNeighbors,
-                                                  newBeginX, newBeginP, newBeginR, max_k, nCalls, sumP, sqP, rsize, drop, flag_o); 
+    \param bitset the bit matrix P was labeled in
 
+    \param setP P, which is not empty
 
-        beginR = beginR + 1;
-    }
+    \param rsize the number of vertices in R
 
-    cliqueCounts[0] = 1;
+    \param drop the number of pivots among them
 
-    
-    Free(vertexSets);
-    Free(vertexLookup);
+    The rest are as in visitCall_A.
+*/
 
-    for(i = 0; i<size; i++)
-    {
-        Free(neighborsInP[i]);
-        Free(orderingArray[i]->later);
-        Free(orderingArray[i]->earlier);
-        Free(orderingArray[i]);
-    }
+static void expandBitset_A(count_t* cliqueCounts, BitsetGraph* bitset, const uint64_t* setP,
+                           int min_k, int max_k, double *nCalls, double *sumP, double *sqP,
+                           int rsize, int drop, int* keepV, int* dropV, TwinWeights* twins)
+{
+    int numWords = bitset->numWords;
+    int pivot = findBestPivotBitset(bitset, setP);
 
-    Free(neighborsInP);
-    Free(numNeighbors);
+    uint64_t remaining[BITSET_WORDS];
+    uint64_t newP[BITSET_WORDS];
 
-    return;
+    for (int w = 0; w < numWords; w++)
+        remaining[w] = setP[w];
+
+    for (int w = 0; w < numWords; w++)
+    {
+        uint64_t word = setP[w] & ~bitset->adjacency[pivot][w];
+        while (word != 0)
+        {
+            int label = 64*w + __builtin_ctzll(word);
+            int vertex = bitset->vertex[label];
+            const uint64_t* row = bitset->adjacency[label];
+
+            remaining[w] &= ~(1ULL << (label%64));
+            for (int x = 0; x < numWords; x++)
+                newP[x] = remaining[x] & row[x];
+
+            if (label == pivot)
+            {
+                if (twins != NULL) dropV[drop] = vertex;
+                listAllCliquesBitsetRecursive_A(cliqueCounts, bitset, newP, min_k, max_k, nCalls, sumP, sqP,
+                                                rsize+1, drop+1, keepV, dropV, twins);
+            }
+            else
+            {
+                if (twins != NULL) keepV[rsize-drop] = vertex;
+                listAllCliquesBitsetRecursive_A(cliqueCounts, bitset, newP, min_k, max_k, nCalls, sumP, sqP,
+                                                rsize+1, drop, keepV, dropV, twins);
+            }
+
+            word &= word - 1;
+        }
+    }
 }
 
-/*! \brief Recursively list all maximal cliques containing all of
-           all vertices in R, some vertices in P and no vertices in X.
+/*! \brief visitCall_A for a P that has moved to
+           bitsets; every call below it stays on bitsets.
+*/
 
-    \param cliqueCount A pointer to the number of maximal cliques computed 
-                       thus far.
+static void listAllCliquesBitsetRecursive_A(count_t* cliqueCounts, BitsetGraph* bitset, const uint64_t* setP,
+                                            int min_k, int max_k, double *nCalls, double *sumP, double *sqP,
+                                            int rsize, int drop, int* keepV, int* dropV, TwinWeights* twins)
+{
+    int sizeOfP = bitsetCount(setP, bitset->numWords);
 
-    \param cliques A linked list of cliques to return. <b>(only available when compiled 
-                   with RETURN_CLIQUES_ONE_BY_ONE defined)</b>
+    *nCalls = (*nCalls) + 1;
+    *sumP = *sumP + sizeOfP;
+    *sqP = *sqP + (sizeOfP*sizeOfP);
 
-    \param partialClique A linked list storing R, the partial clique for this
-                         recursive call. 
+    if ((twins == NULL) && (rsize + sizeOfP < min_k))
+        return;
 
-    \param vertexSets An array containing sets of vertices divided into sets X, P, R and other.
- 
-    \param vertexLookup A lookup table indexed by vertex number, storing the index of that 
-                        vertex in vertexSets.
+    if ((sizeOfP == 0) || (rsize-drop > max_k))
+    {
+        addCliques_A(cliqueCounts, rsize, drop, keepV, dropV, twins, min_k, max_k);
+        return;
+    }
 
-    \param neighborsInP Maps vertices to arrays of neighbors such that 
-                        neighbors in P fill the first cells
+    expandBitset_A(cliqueCounts, bitset, setP, min_k, max_k, nCalls, sumP, sqP, rsize, drop, keepV, dropV, twins);
+}
+
+/*! \brief visit a call of the recursion: count it, add the cliques of a
+           leaf, finish a small P on bitsets, or push a frame to branch on
+           its candidates.
 
-    \param numNeighbors An the neighbor of neighbors a vertex had in P,
-                        the first time this function is called, this bound is 
-                        used to keep us from allocating more than linear space.
+    \param search the search
 
     \param beginX The index where set X begins in vertexSets.
- 
+
     \param beginP The index where set P begins in vertexSets.
 
     \param beginR The index where set R begins in vertexSets.
 
+    \param keep the number of vertices of R that are not pivots
+
+    \param drop the number of pivots in R
 */
 
-void listAllCliquesDegeneracyRecursive_A( double * cliqueCounts,
-                                               int* vertexSets, int* vertexLookup,
-                                               int** neighborsInP, int* numNeighbors,
-                                               int beginX, int beginP, int beginR, int max_k, 
-                                               double *nCalls, double *sumP, double *sqP, 
-                                               int rsize, int drop, int flag_o)
+static void visitCall_A(PivotSearch* search, int beginX, int beginP, int beginR, int keep, int drop)
 {
-    *nCalls = (*nCalls) + 1;
-    *sumP = *sumP + (beginR - beginP);
-    *sqP = *sqP + ((beginR - beginP)*(beginR - beginP));
-    
-    if ((beginP >= beginR) || (rsize-drop > max_k))
+    search->nCalls = search->nCalls + 1;
+    search->sumP = search->sumP + (beginR - beginP);
+    search->sqP = search->sqP + ((beginR - beginP)*(beginR - beginP));
+
+    // no clique below here is large enough to count (a class of twins
+    // may stand for several vertices, so only without twins)
+    if ((search->twins == NULL) && (keep + drop + (beginR - beginP) < search->min_k))
+        return;
+
+    if ((beginP >= beginR) || (keep > search->max_k))
     {
-        for (int i=drop; (i>=0) && (rsize-i <= max_k); i--) 
-        {
-            int k = rsize - i;
-            cliqueCounts[k] += nCr[drop][i];
-        }
-       
+        addCliques_A(search->cliqueCounts, keep + drop, drop, search->keepV, search->dropV,
+                     search->twins, search->min_k, search->max_k);
         return;
     }
-    
-    int* myCandidatesToIterateThrough;
-    int numCandidatesToIterateThrough = 0;
-    int pivot;
-    // get the candidates to add to R to make a maximal clique
-    pivot = findBestPivotNonNeighborsDegeneracyCliques( &myCandidatesToIterateThrough,
-                                                              &numCandidatesToIterateThrough,
-                                                              vertexSets, vertexLookup,
-                                                              neighborsInP, numNeighbors,
-                                                              beginX, beginP, beginR);
-
-    // add candiate vertices to the partial clique one at a time and 
-    // search for maximal cliques
-    if(numCandidatesToIterateThrough != 0)
+
+    // a small, dense P goes on with bitsets, all the way down
+    uint64_t setP[BITSET_WORDS];
+    if ((search->bitset != NULL) && fillInBitsetForRecursiveCall(search->bitset, search->vertexSets, search->vertexLookup,
+                                                                 search->neighborsInP, search->numNeighbors,
+                                                                 beginP, beginR, setP))
     {
-        int iterator = 0;
-        while(iterator < numCandidatesToIterateThrough)
-        {
-            // vertex to be added to the partial clique
-            int vertex = myCandidatesToIterateThrough[iterator];
+        expandBitset_A(search->cliqueCounts, search->bitset, setP, search->min_k, search->max_k,
+                       &search->nCalls, &search->sumP, &search->sqP,
+                       keep + drop, drop, search->keepV, search->dropV, search->twins);
+        return;
+    }
 
-            int newBeginX, newBeginP, newBeginR;
+    pushPivotFrame(search, beginX, beginP, beginR, keep, drop);
+}
 
-            // add vertex into partialClique, representing R.
+/*! \brief run the recursion from the frames of a search, for at most a
+           number of calls. A P that moved to bitsets is finished in one
+           call.
 
-            // swap vertex into R and update all data structures 
-            moveToRDegeneracyCliques( vertex, 
-                               vertexSets, vertexLookup, 
-                               neighborsInP, numNeighbors,
-                               &beginX, &beginP, &beginR, 
-                               &newBeginX, &newBeginP, &newBeginR);
+    \param search the search, from a root visited with visitCall_A
 
+    \param maxCalls the largest number of calls to visit, or -1 for no limit
 
-            
-            // recursively compute maximal cliques with new sets R, P and X
-            if (vertex == pivot)
-                listAllCliquesDegeneracyRecursive_A(cliqueCounts,
-                                                      vertexSets, vertexLookup,
-                                                      neighborsInP, numNeighbors,
-                                                      newBeginX, newBeginP, newBeginR, max_k, nCalls, sumP, sqP, rsize+1, drop+1, flag_o);
-            else
-                listAllCliquesDegeneracyRecursive_A(cliqueCounts,
-                                                      vertexSets, vertexLookup,
-                                                      neighborsInP, numNeighbors,
-                                                      newBeginX, newBeginP, newBeginR, max_k, nCalls, sumP, sqP, rsize+1, drop, flag_o);
+    \return 1 if the search is done (it has no frames left), or 0 if it
+            stopped at maxCalls. Calling it again goes on where it stopped.
+*/
 
+static int resumePivotSearch_A(PivotSearch* search, long maxCalls)
+{
+    long calls = 0;
 
-            moveFromRToXDegeneracyCliques( vertex, 
-                                    vertexSets, vertexLookup,
-                                    &beginX, &beginP, &beginR );
+    while (search->depth > 0)
+    {
+        if (calls == maxCalls)
+            return 0;
 
-            iterator++;
+        int newBeginX, newBeginP, newBeginR, keep, drop;
+        if (nextPivotCall(search, &newBeginX, &newBeginP, &newBeginR, &keep, &drop))
+        {
+            visitCall_A(search, newBeginX, newBeginP, newBeginR, keep, drop);
+            calls++;
         }
+    }
 
-        // swap vertices that were moved to X back into P, for higher recursive calls.
-        iterator = 0;
-        while(iterator < numCandidatesToIterateThrough)
-        {
-            int vertex = myCandidatesToIterateThrough[iterator];
-            int vertexLocation = vertexLookup[vertex];
+    return 1;
+}
 
-            beginP--;
-            vertexSets[vertexLocation] = vertexSets[beginP];
-            vertexSets[beginP] = vertex;
-            vertexLookup[vertex] = beginP;
-            vertexLookup[vertexSets[vertexLocation]] = vertexLocation;
+void listAllCliquesDegeneracy_A(count_t * cliqueCounts, OrientedGraph* orientedGraph, 
+                                      int size, int degeneracy, int min_k, int max_k, double *nCalls, double *sumP, double *sqP,
+                                      int bitsetBits, double bitsetDensity)
+{
+    *nCalls = (*nCalls) + 1;
 
-            iterator++;
-        }
+    PivotSearch* search = createPivotSearch(orientedGraph, size, degeneracy, cliqueCounts, min_k, max_k, bitsetBits, bitsetDensity);
+
+    int beginX = 0;
+    int beginP = 0;
+    int beginR = size;
+
+    // for each vertex
+    for(int i=0;i<size;i++)
+    {
+        int vertex = i;
+        
+        int newBeginX, newBeginP, newBeginR;
+
+        // set P to be later neighbors and X to be be earlier neighbors
+        // of vertex
+        fillInPandXForRecursiveCallDegeneracyCliques( vertex,
+                                               search->vertexSets, search->vertexLookup, 
+                                               orientedGraph,
+                                               search->neighborsInP, search->numNeighbors,
+                                               &beginX, &beginP, &beginR, 
+                                               &newBeginX, &newBeginP, &newBeginR,
+                                               search->arena);
+
+        search->sumP = search->sumP + (newBeginR - newBeginP);
+        search->sqP = search->sqP + ((newBeginR - newBeginP)*(newBeginR - newBeginP));
+
+        // compute the cliques containing vertex, some of its later
+        // neighbors, and avoiding earlier neighbors
+        search->keepV[0] = vertex;
+        visitCall_A(search, newBeginX, newBeginP, newBeginR, 1, 0);
+        resumePivotSearch_A(search, -1);
+
+        beginR = beginR + 1;
     }
 
-    // don't need to check for emptiness before freeing, since
-    // something will always be there (we allocated enough memory
-    // for all of P, which is nonempty)
-    Free(myCandidatesToIterateThrough);
-    
+    // the empty clique
+    if (min_k == 0)
+        cliqueCounts[0] = 1;
+
+    *nCalls = *nCalls + search->nCalls;
+    *sumP = *sumP + search->sumP;
+    *sqP = *sqP + search->sqP;
+
+    destroyPivotSearch(search);
+
     return;
 }
+
+/*! \brief estimate how much work the recursion does under an ordering by
+           running it from a sample of root vertices.
+
+    \param orientedGraph an ordering, indexed by vertex; it is not freed
+
+    \param size the number of vertices in the graph
+
+    \param degeneracy the degeneracy of the graph, which bounds the depth
+                      of the recursion
+
+    \param max_k the largest clique size to count
+
+    \param roots the vertices to start the recursion from
+
+    \param numRoots the number of vertices in roots
+
+    \param budget stop in the middle of a root once the cost is above this;
+                  negative for no limit
+
+    \param seconds if not NULL, set to the time spent in the recursion from
+                   the roots, without setting up the vertex arrays
+
+    \return the number of recursive calls plus the sum of the squared sizes
+            of P over those calls, for the sampled roots only. Choosing a
+            pivot takes up to |P|^2 steps, so this tracks the running time
+            better than the number of calls alone. If it stopped early, the
+            cost so far, which is above budget.
+*/
+
+double sampleRecursionCost_A(OrientedGraph* orientedGraph, int size, int degeneracy, int max_k,
+                             int* roots, int numRoots, double budget, double* seconds)
+{
+    count_t* cliqueCounts = (count_t *)Calloc(max_k + 1, sizeof(count_t));
+    PivotSearch* search = createPivotSearch(orientedGraph, size, degeneracy, cliqueCounts, 0, max_k, 0, 0);
+
+    int beginX = 0;
+    int beginP = 0;
+    int beginR = size;
+
+    struct timespec rootsStart, rootsEnd;
+    clock_gettime(CLOCK_MONOTONIC, &rootsStart);
+
+    for(int i=0; i<numRoots; i++)
+    {
+        int vertex = roots[i];
+        int newBeginX, newBeginP, newBeginR;
+
+        fillInPandXForRecursiveCallDegeneracyCliques( vertex,
+                                               search->vertexSets, search->vertexLookup,
+                                               orientedGraph,
+                                               search->neighborsInP, search->numNeighbors,
+                                               &beginX, &beginP, &beginR,
+                                               &newBeginX, &newBeginP, &newBeginR,
+                                               search->arena);
+
+        // run the root a slice at a time, so that a root far costlier
+        // than the budget is given up soon after it passes it
+        search->keepV[0] = vertex;
+        visitCall_A(search, newBeginX, newBeginP, newBeginR, 1, 0);
+        while (!resumePivotSearch_A(search, (budget < 0) ? -1 : SAMPLE_SLICE_CALLS))
+        {
+            if (search->nCalls + search->sqP > budget)
+                abandonPivotSearch(search);
+        }
+
+        beginR = beginR + 1;
+
+        if ((budget >= 0) && (search->nCalls + search->sqP > budget))
+            break;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &rootsEnd);
+    if (seconds != NULL)
+        *seconds = (double)(rootsEnd.tv_sec - rootsStart.tv_sec) + 1e-9*(rootsEnd.tv_nsec - rootsStart.tv_nsec);
+
+    double cost = search->nCalls + search->sqP;
+
+    destroyPivotSearch(search);
+    Free(cliqueCounts);
+
+    return cost;
+}
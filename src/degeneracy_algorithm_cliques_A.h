@@ -42,12 +42,11 @@
 
 
 
-void listAllCliquesDegeneracyRecursive_A(double *,
-                                               int* vertexSets, int* vertexLookup,
-                                               int** neighborsInP, int* numNeighbors,
-                                               int beginX, int beginP, int beginR, int max_k, double *nCalls, double *sumP, double *sqP, int rsize, int drop, int flag_o);
+void listAllCliquesDegeneracy_A( count_t *, OrientedGraph* orientedGraph,
+                                      int size, int degeneracy, int min_k, int max_k, double *nCalls, double *sumP, double *sqP,
+                                      int bitsetBits, double bitsetDensity);
 
-void listAllCliquesDegeneracy_A( double *, NeighborListArray** orderingArray,
-                                      int size, int max_k, double *nCalls, double *sumP, double *sqP,int flag_o);
+double sampleRecursionCost_A(OrientedGraph* orientedGraph, int size, int degeneracy, int max_k,
+                             int* roots, int numRoots, double budget, double* seconds);
 
 #endif
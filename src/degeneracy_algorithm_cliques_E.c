@@ -38,328 +38,478 @@
 #include"degeneracy_helper.h"
 #include"degeneracy_algorithm_cliques_E.h"
 
-extern double nCr[1001][401];
 
 
-/*! 
-    \param adjList An array of linked lists, representing the input graph in the
-                   "typical" adjacency list format.
- 
-    \param adjacencyList an array of arrays, representing the input graph in a more
-                         compact and cache-friendly adjacency list format. (not currently used)
+/*! \brief the index in CSCedges of the edge between two vertices.
 
-    \param cliques A linked list of cliques to return. <b>(only available when compiled 
-                   with RETURN_CLIQUES_ONE_BY_ONE defined)</b>
+    \param u a vertex
 
-    \param degree An array, indexed by vertex, containing the degree of that vertex. (not currently used)
+    \param v a neighbor of u
 
-    \param size The number of vertices in the graph.
+    \param ordering the position of each vertex in the ordering
 
-    \return the number of maximal cliques of the input graph.
+    \param CSCindex where the later neighbors of each vertex begin in CSCedges
+
+    \param CSCedges the later neighbors of every vertex, each list sorted
+
+    \return the index, or -1 (with an error message) if there is no edge.
 */
 
-void listAllCliquesDegeneracy_E(double* cliqueCounts, 
-                                      NeighborListArray** orderingArray,
-                                      int *ordering,
-                                      int *CSCindex,
-                                      int *CSCedges,
-                                      int size, int max_k)
+static long twinEdgeIndex(int u, int v, int* ordering, long* CSCindex, int* CSCedges)
 {
-    // vertex sets are stored in an array like this:
-    // |--X--|--P--|
-    int* vertexSets = (int *)Calloc(size, sizeof(int));
+    if (ordering[u] > ordering[v])
+    {
+        int temp = u;
+        u = v;
+        v = temp;
+    }
+
+    long index = findNbrCSC(u,v,CSCindex, CSCedges); // find the index of v in u's neighbor list
+
+    if (index == -1) fprintf(stderr, "Error. v not found in u's list\n");
+
+    return index;
+}
+
+/*! \brief add the cliques a leaf of the recursion stands for on a graph
+           of twin classes to the counts of its edges. Every edge between
+           the same two classes has the same counts, so the count of an
+           edge between two classes is that of each input edge between
+           them: fix one vertex at each end and let the rest of their
+           classes be free. Edges inside a class go to withinCounts.
+
+    \param cliqueCounts the number of k-cliques of each edge, for each k
+                        from min_k to max_k
+
+    \param ordering the position of each vertex in the ordering
 
-    // vertex i is stored in vertexSets[vertexLookup[i]]
-    int* vertexLookup = (int *)Calloc(size, sizeof(int));
+    \param CSCindex where the later neighbors of each vertex begin in CSCedges
 
-    int** neighborsInP = (int **)Calloc(size, sizeof(int*));
-    int* numNeighbors = (int *)Calloc(size, sizeof(int));
+    \param CSCedges the later neighbors of every vertex, each list sorted
 
-    int i = 0;
-    int deg = 0;
+    \param keepV the kept vertices
 
-    while(i<size)
+    \param keep the number of kept vertices
+
+    \param dropV the dropped vertices
+
+    \param drop the number of dropped vertices
+
+    \param twins the weights, scratch space and withinCounts
+
+    \param min_k the smallest clique size to count
+
+    \param max_k the largest clique size to count
+*/
+
+static void addTwinCliques_E(count_t* cliqueCounts, int* ordering, long* CSCindex, int* CSCedges,
+                             int* keepV, int keep, int* dropV, int drop, TwinWeights* twins, int min_k, int max_k)
+{
+    int* weight = twins->weight;
+    long numK = max_k - min_k + 1;
+    int lowestK = max(2, min_k);
+    int dropWeight = 0;
+    for (int j = 0; j < drop; j++)
+        dropWeight += weight[dropV[j]];
+
+    int lowest = twinKeepPolynomial(twins->keepPoly, keepV, keep, -1, -1, weight, max_k);
+
+    // an edge with both ends in dropped classes, the same or two different
+    // ones, leaves every kept class and the rest of the dropped vertices
+    count_t* dropCliques = twins->otherPoly;
+    for (int k = lowestK; k <= max_k; k++)
+        dropCliques[k] = twinBinomialSum(twins->keepPoly, lowest, dropWeight - 2, k - 2);
+
+    for (int i = 0; i < drop; i++)
     {
-        vertexLookup[i] = i;
-        vertexSets[i] = i;
-        neighborsInP[i] = (int *)Calloc(1, sizeof(int));
-        numNeighbors[i] = 1;
-        i++;
+        for (int j = i + 1; j < drop; j++)
+        {
+            long index = twinEdgeIndex(dropV[i], dropV[j], ordering, CSCindex, CSCedges);
+            for (int k = lowestK; k <= max_k; k++)
+                cliqueCounts[index*numK + k - min_k] += dropCliques[k];
+        }
+
+        if ((weight[dropV[i]] > 1) && (twins->withinCounts != NULL))
+        {
+            for (int k = lowestK; k <= max_k; k++)
+                twins->withinCounts[dropV[i]*numK + k - min_k] += dropCliques[k];
+        }
     }
-    
-    int beginX = 0;
-    int beginP = 0;
-    int beginR = size;
 
-    int* dropV = (int *)Calloc(MAX_CSIZE, sizeof(int));
-    int* keepV = (int *)Calloc(MAX_CSIZE, sizeof(int));
-  //printf("Ready?");
-    //scanf("%d", &i);
-    // for each vertex
-    for(i=0;i<size;i++)
+    for (int i = 0; i < keep; i++)
     {
-        int vertex = (int)orderingArray[i]->vertex;
-        //printf("vertex = %d", vertex);
-        //fflush(stdout);
-        int newBeginX, newBeginP, newBeginR;
+        int u = keepV[i];
 
-        //printf("Before fillIn\n");
-        // set P to be later neighbors and X to be be earlier neighbors
-        // of vertex
-        fillInPandXForRecursiveCallDegeneracyCliques( i, vertex, 
-                                               vertexSets, vertexLookup, 
-                                               orderingArray,
-                                               neighborsInP, numNeighbors,
-                                               &beginX, &beginP, &beginR, 
-                                               &newBeginX, &newBeginP, &newBeginR);
-
-        // recursively compute maximal cliques containing vertex, some of its
-        // later neighbors, and avoiding earlier neighbors
-        int drop = 0;
-        int keep = 1;
-        memset(keepV, 0, MAX_CSIZE);
-        memset(dropV, 0, MAX_CSIZE);
-        keepV[keep-1] = vertex;
-        //printf("Calling Rec function.\n");
-        listAllCliquesDegeneracyRecursive_E(cliqueCounts,
-                                                  ordering,
-                                                  CSCindex,
-                                                  CSCedges,
-                                                  vertexSets, vertexLookup,
-                                                  neighborsInP, numNeighbors,
-                                                  newBeginX, newBeginP, newBeginR, keep, drop, keepV, dropV, max_k); 
+        for (int j = i + 1; j < keep; j++)
+        {
+            int v = keepV[j];
+            int otherLowest = twinKeepPolynomial(twins->otherPoly, keepV, keep, i, j, weight, max_k);
+            long index = twinEdgeIndex(u, v, ordering, CSCindex, CSCedges);
 
-        beginR = beginR + 1;
+            for (int k = lowestK; k <= max_k; k++)
+                cliqueCounts[index*numK + k - min_k] += twinBinomialSum(twins->otherPoly, otherLowest, dropWeight + weight[u] + weight[v] - 2, k - 2);
+        }
 
-    }
-    
-    Free(vertexSets);
-    Free(vertexLookup);
+        int otherLowest = twinKeepPolynomial(twins->otherPoly, keepV, keep, i, -1, weight, max_k);
 
-    for(i = 0; i<size; i++)
-    {
-        Free(neighborsInP[i]);
-        Free(orderingArray[i]->later);
-        Free(orderingArray[i]->earlier);
-        Free(orderingArray[i]);
-    }
+        for (int j = 0; j < drop; j++)
+        {
+            long index = twinEdgeIndex(u, dropV[j], ordering, CSCindex, CSCedges);
 
-    Free(neighborsInP);
-    Free(numNeighbors);
+            for (int k = lowestK; k <= max_k; k++)
+                cliqueCounts[index*numK + k - min_k] += twinBinomialSum(twins->otherPoly, otherLowest, dropWeight + weight[u] - 2, k - 2);
+        }
 
-    return;
+        if ((weight[u] > 1) && (twins->withinCounts != NULL))
+        {
+            for (int k = lowestK; k <= max_k; k++)
+                twins->withinCounts[u*numK + k - min_k] += twinBinomialSum(twins->otherPoly, otherLowest, dropWeight + weight[u] - 2, k - 2);
+        }
+    }
 }
 
+/*! \brief add the cliques a leaf of the recursion stands for to the
+           counts of its edges: R with any subset of the dropped (pivot)
+           vertices. An edge between two kept vertices is in all of them,
+           and an edge with a dropped end in those that take it.
 
-/*! \brief Recursively list all maximal cliques containing all of
-           all vertices in R, some vertices in P and no vertices in X.
+    \param cliqueCounts the number of k-cliques of each edge, for each k
+                        from min_k to max_k
 
-    \param cliqueCount A pointer to the number of maximal cliques computed 
-                       thus far.
+    \param ordering the position of each vertex in the ordering
 
-    \param cliques A linked list of cliques to return. <b>(only available when compiled 
-                   with RETURN_CLIQUES_ONE_BY_ONE defined)</b>
+    \param CSCindex where the later neighbors of each vertex begin in CSCedges
 
-    \param partialClique A linked list storing R, the partial clique for this
-                         recursive call. 
+    \param CSCedges the later neighbors of every vertex, each list sorted
 
-    \param vertexSets An array containing sets of vertices divided into sets X, P, R and other.
- 
-    \param vertexLookup A lookup table indexed by vertex number, storing the index of that 
-                        vertex in vertexSets.
+    \param keep the number of kept vertices
 
-    \param neighborsInP Maps vertices to arrays of neighbors such that 
-                        neighbors in P fill the first cells
+    \param drop the number of dropped vertices
 
-    \param numNeighbors An the neighbor of neighbors a vertex had in P,
-                        the first time this function is called, this bound is 
-                        used to keep us from allocating more than linear space.
+    \param keepV the kept vertices
 
-    \param beginX The index where set X begins in vertexSets.
- 
-    \param beginP The index where set P begins in vertexSets.
+    \param dropV the dropped vertices
 
-    \param beginR The index where set R begins in vertexSets.
+    \param twins the weights, scratch space and withinCounts, or NULL
+
+    \param min_k the smallest clique size to count
 
+    \param max_k the largest clique size to count
 */
 
-void listAllCliquesDegeneracyRecursive_E(double* cliqueCounts,
-                                               int *ordering,
-                                               int *CSCindex,
-                                               int *CSCedges,
-                                               int* vertexSets, int* vertexLookup,
-                                               int** neighborsInP, int* numNeighbors,
-                                               int beginX, int beginP, int beginR,
-                                               int keep, int drop, int *keepV, int *dropV, int max_k)
+static void addCliques_E(count_t* cliqueCounts, int* ordering, long* CSCindex, int* CSCedges,
+                         int keep, int drop, int* keepV, int* dropV, TwinWeights* twins, int min_k, int max_k)
 {
-  //printf("In rec function.\n");
-    if ((beginP >= beginR) || (keep > max_k))
+    if (twins != NULL)
+    {
+        addTwinCliques_E(cliqueCounts, ordering, CSCindex, CSCedges, keepV, keep, dropV, drop, twins, min_k, max_k);
+        return;
+    }
+
+    long numK = max_k - min_k + 1;
+    int temp = 0;
+    for (int i=0; i<keep; i++)
     {
-        int temp = 0;
-        for (int i=0; i<keep; i++)
+        for (int j=i+1; j<keep; j++)
         {
-            for (int j=i+1; j<keep; j++)
+            int u = keepV[i];
+            int v = keepV[j];
+            if (ordering[u] > ordering[v])
+            {
+                temp = u;
+                u = v;
+                v = temp;
+            }
+
+            long index = findNbrCSC(u,v,CSCindex, CSCedges); // find the index of v in u's neighbor list
+
+            if (index == -1) fprintf(stderr, "Error. v not found in u's list\n");
+
+            for (int l=min(drop, keep+drop-min_k); (l>=0) && (keep+drop-l <= max_k); l--) 
             {
-                int u = keepV[i];
-                int v = keepV[j];
-                if (ordering[u] > ordering[v])
-                {
-                    temp = u;
-                    u = v;
-                    v = temp;
-                }
-
-                int index = findNbrCSC(u,v,CSCindex, CSCedges); // find the index of v in u's neighbor list
-
-                if (index == -1) fprintf(stderr, "Error. v not found in u's list\n");
-
-                for (int l=drop; (l>=0) && (keep+drop-l <= max_k); l--) 
-                {
-                    int k = keep + drop - l;
-                    long in = (long)index*(long)(max_k+1) + (long)k;
-                    cliqueCounts[in] += nCr[drop][l];
-                }
+                int k = keep + drop - l;
+                long in = index*numK + (long)(k - min_k);
+                cliqueCounts[in] += nCr[drop][l];
             }
         }
-        for (int i=0; i<drop; i++)
+    }
+    for (int i=0; i<drop; i++)
+    {
+        for (int j=i+1; j<drop; j++)
         {
-            for (int j=i+1; j<drop; j++)
+            int u = dropV[i];
+            int v = dropV[j];
+            if (ordering[u] > ordering[v])
+            {
+                temp = u;
+                u = v;
+                v = temp;
+            }
+            long index = findNbrCSC(u,v,CSCindex, CSCedges); // find the index of v in u's neighbor list
+            if (index == -1) fprintf(stderr, "Error. v not found in u's list\n");
+            for (int l=min(drop-2, keep+drop-min_k); (l>=0) && (keep+drop-l <= max_k); l--)
             {
-                int u = dropV[i];
-                int v = dropV[j];
-                if (ordering[u] > ordering[v])
-                {
-                    temp = u;
-                    u = v;
-                    v = temp;
-                }
-                int index = findNbrCSC(u,v,CSCindex, CSCedges); // find the index of v in u's neighbor list
-                if (index == -1) fprintf(stderr, "Error. v not found in u's list\n");
-                for (int l=drop-2; (l>=0) && (keep+drop-l <= max_k); l--)
-                {
-                    int k = keep + drop - l;
-                    long in = (long)index*(long)(max_k+1) + (long)k;
-                    cliqueCounts[in] += nCr[drop-2][l];
-                }
+                int k = keep + drop - l;
+                long in = index*numK + (long)(k - min_k);
+                cliqueCounts[in] += nCr[drop-2][l];
             }
         }
+    }
 
-        for (int i=0; i<keep; i++)
+    for (int i=0; i<keep; i++)
+    {
+        for (int j=0; j<drop; j++)
         {
-            for (int j=0; j<drop; j++)
+            int u = keepV[i];
+            int v = dropV[j];
+            if (ordering[u] > ordering[v])
             {
-                int u = keepV[i];
-                int v = dropV[j];
-                if (ordering[u] > ordering[v])
-                {
-                    temp = u;
-                    u = v;
-                    v = temp;
-                }
-                int index = findNbrCSC(u,v,CSCindex, CSCedges); // find the index of v in u's neighbor list
-                if (index == -1) fprintf(stderr, "Error. v not found in u's list\n");
-                for (int l=drop-1; (l>=0) && (keep+drop-l <= max_k); l--)
-                {
-                    int k = keep + drop - l;
-                    long s = (long)(max_k + 1);
-                    long in = (long)index*s + (long)k;
-                    cliqueCounts[in] += nCr[drop-1][l];
-                }
+                temp = u;
+                u = v;
+                v = temp;
+            }
+            long index = findNbrCSC(u,v,CSCindex, CSCedges); // find the index of v in u's neighbor list
+            if (index == -1) fprintf(stderr, "Error. v not found in u's list\n");
+            for (int l=min(drop-1, keep+drop-min_k); (l>=0) && (keep+drop-l <= max_k); l--)
+            {
+                int k = keep + drop - l;
+                long in = index*numK + (long)(k - min_k);
+                cliqueCounts[in] += nCr[drop-1][l];
             }
         }
-        return;
     }
-    
-    int* myCandidatesToIterateThrough;
-    int numCandidatesToIterateThrough;
+}
 
-    //printf("About to find pivot\n");
-    // get the candidates to add to R to make a maximal clique
-    int pivot = findBestPivotNonNeighborsDegeneracyCliques( &myCandidatesToIterateThrough,
-                                         &numCandidatesToIterateThrough,
-                                         vertexSets, vertexLookup,
-                                         neighborsInP, numNeighbors,
-                                         beginX, beginP, beginR);
+static void listAllCliquesBitsetRecursive_E(count_t* cliqueCounts, int* ordering, long* CSCindex, int* CSCedges,
+                                            BitsetGraph* bitset, const uint64_t* setP,
+                                            int keep, int drop, int* keepV, int* dropV, int min_k, int max_k,
+                                            TwinWeights* twins);
 
-    
+/*! \brief branch on the candidates of a call whose P is a bitset: the
+           vertices of P that are not neighbors of the pivot. Each one is
+           added to R with P cut down to its neighbors, and then leaves P.
 
-    // add candiate vertices to the partial clique one at a time and 
-    // search for maximal cliques
-    if(numCandidatesToIterateThrough != 0)
-    {
-        int iterator = 0;
-        while(iterator < numCandidatesToIterateThrough)
-        {
-            // vertex to be added to the partial clique
-            int vertex = myCandidatesToIterateThrough[iterator];
+    \param cliqueCounts the number of k-cliques of each edge, for each k
+                        from min_k to max_k
+
+    \param bitset the bit matrix P was labeled in
+
+    \param setP P, which is not empty
+
+    The rest are as in visitCall_E.
+*/
+
+static void expandBitset_E(count_t* cliqueCounts, int* ordering, long* CSCindex, int* CSCedges,
+                           BitsetGraph* bitset, const uint64_t* setP,
+                           int keep, int drop, int* keepV, int* dropV, int min_k, int max_k,
+                           TwinWeights* twins)
+{
+    int numWords = bitset->numWords;
+    int pivot = findBestPivotBitset(bitset, setP);
 
-            int newBeginX, newBeginP, newBeginR;
+    uint64_t remaining[BITSET_WORDS];
+    uint64_t newP[BITSET_WORDS];
 
-            // add vertex into partialClique, representing R.
-            // Link* vertexLink = addLast(partialClique, (int)vertex);
+    for (int w = 0; w < numWords; w++)
+        remaining[w] = setP[w];
 
-            //printf("About to call moveToR\n");
-            // swap vertex into R and update all data structures 
-            moveToRDegeneracyCliques( vertex, 
-                               vertexSets, vertexLookup, 
-                               neighborsInP, numNeighbors,
-                               &beginX, &beginP, &beginR, 
-                               &newBeginX, &newBeginP, &newBeginR);
+    for (int w = 0; w < numWords; w++)
+    {
+        uint64_t word = setP[w] & ~bitset->adjacency[pivot][w];
+        while (word != 0)
+        {
+            int label = 64*w + __builtin_ctzll(word);
+            const uint64_t* row = bitset->adjacency[label];
 
+            remaining[w] &= ~(1ULL << (label%64));
+            for (int x = 0; x < numWords; x++)
+                newP[x] = remaining[x] & row[x];
 
-            
-            // recursively compute maximal cliques with new sets R, P and X
-            if (vertex == pivot)
+            if (label == pivot)
             {
-                dropV[drop] = vertex;
-                listAllCliquesDegeneracyRecursive_E(cliqueCounts,
-                                                      ordering,
-                                                      CSCindex,
-                                                      CSCedges,
-                                                      vertexSets, vertexLookup,
-                                                      neighborsInP, numNeighbors,
-                                                      newBeginX, newBeginP, newBeginR, keep, drop+1, keepV, dropV, max_k);
+                dropV[drop] = bitset->vertex[label];
+                listAllCliquesBitsetRecursive_E(cliqueCounts, ordering, CSCindex, CSCedges, bitset, newP,
+                                                keep, drop+1, keepV, dropV, min_k, max_k, twins);
             }
             else
             {
-                keepV[keep] = vertex;
-                listAllCliquesDegeneracyRecursive_E(cliqueCounts,
-                                                      ordering,
-                                                      CSCindex,
-                                                      CSCedges,
-                                                      vertexSets, vertexLookup,
-                                                      neighborsInP, numNeighbors,
-                                                      newBeginX, newBeginP, newBeginR, keep+1, drop, keepV, dropV, max_k);
+                keepV[keep] = bitset->vertex[label];
+                listAllCliquesBitsetRecursive_E(cliqueCounts, ordering, CSCindex, CSCedges, bitset, newP,
+                                                keep+1, drop, keepV, dropV, min_k, max_k, twins);
             }
-  //printf("Returned from rec function.  Calling moveFromR.\n");
-            moveFromRToXDegeneracyCliques( vertex, 
-                                    vertexSets, vertexLookup,
-                                    &beginX, &beginP, &beginR );
 
-            iterator++;
+            word &= word - 1;
         }
+    }
+}
 
-        // swap vertices that were moved to X back into P, for higher recursive calls.
-        iterator = 0;
-        while(iterator < numCandidatesToIterateThrough)
-        {
-            int vertex = myCandidatesToIterateThrough[iterator];
-            int vertexLocation = vertexLookup[vertex];
+/*! \brief visitCall_E for a P that has moved to
+           bitsets; every call below it stays on bitsets.
+*/
+
+static void listAllCliquesBitsetRecursive_E(count_t* cliqueCounts, int* ordering, long* CSCindex, int* CSCedges,
+                                            BitsetGraph* bitset, const uint64_t* setP,
+                                            int keep, int drop, int* keepV, int* dropV, int min_k, int max_k,
+                                            TwinWeights* twins)
+{
+    int sizeOfP = bitsetCount(setP, bitset->numWords);
+
+    if ((twins == NULL) && (keep + drop + sizeOfP < min_k))
+        return;
+
+    if ((sizeOfP == 0) || (keep > max_k))
+    {
+        addCliques_E(cliqueCounts, ordering, CSCindex, CSCedges, keep, drop, keepV, dropV, twins, min_k, max_k);
+        return;
+    }
+
+    expandBitset_E(cliqueCounts, ordering, CSCindex, CSCedges, bitset, setP, keep, drop, keepV, dropV, min_k, max_k, twins);
+}
+
+/*! \brief visit a call of the recursion: add the cliques of a leaf,
+           finish a small P on bitsets, or push a frame to branch on its
+           candidates.
+
+    \param search the search
 
-            beginP--;
-            vertexSets[vertexLocation] = vertexSets[beginP];
-            vertexSets[beginP] = vertex;
-            vertexLookup[vertex] = beginP;
-            vertexLookup[vertexSets[vertexLocation]] = vertexLocation;
+    \param beginX The index where set X begins in vertexSets.
+
+    \param beginP The index where set P begins in vertexSets.
+
+    \param beginR The index where set R begins in vertexSets.
+
+    \param keep the number of vertices of R that are not pivots
+
+    \param drop the number of pivots in R
+*/
+
+static void visitCall_E(PivotSearch* search, int beginX, int beginP, int beginR, int keep, int drop)
+{
+    // no clique below here is large enough to count (a class of twins
+    // may stand for several vertices, so only without twins)
+    if ((search->twins == NULL) && (keep + drop + (beginR - beginP) < search->min_k))
+        return;
+
+    if ((beginP >= beginR) || (keep > search->max_k))
+    {
+        addCliques_E(search->cliqueCounts, search->ordering, search->CSCindex, search->CSCedges,
+                     keep, drop, search->keepV, search->dropV, search->twins, search->min_k, search->max_k);
+        return;
+    }
+
+    // a small, dense P goes on with bitsets, all the way down
+    uint64_t setP[BITSET_WORDS];
+    if ((search->bitset != NULL) && fillInBitsetForRecursiveCall(search->bitset, search->vertexSets, search->vertexLookup,
+                                                                 search->neighborsInP, search->numNeighbors,
+                                                                 beginP, beginR, setP))
+    {
+        expandBitset_E(search->cliqueCounts, search->ordering, search->CSCindex, search->CSCedges,
+                       search->bitset, setP, keep, drop, search->keepV, search->dropV,
+                       search->min_k, search->max_k, search->twins);
+        return;
+    }
+
+    pushPivotFrame(search, beginX, beginP, beginR, keep, drop);
+}
+
+/*! \brief run the recursion from the frames of a search, for at most a
+           number of calls. A P that moved to bitsets is finished in one
+           call.
+
+    \param search the search, from a root visited with visitCall_E
+
+    \param maxCalls the largest number of calls to visit, or -1 for no limit
+
+    \return 1 if the search is done (it has no frames left), or 0 if it
+            stopped at maxCalls. Calling it again goes on where it stopped.
+*/
 
-            iterator++;
+static int resumePivotSearch_E(PivotSearch* search, long maxCalls)
+{
+    long calls = 0;
+
+    while (search->depth > 0)
+    {
+        if (calls == maxCalls)
+            return 0;
+
+        int newBeginX, newBeginP, newBeginR, keep, drop;
+        if (nextPivotCall(search, &newBeginX, &newBeginP, &newBeginR, &keep, &drop))
+        {
+            visitCall_E(search, newBeginX, newBeginP, newBeginR, keep, drop);
+            calls++;
         }
     }
 
-    // don't need to check for emptiness before freeing, since
-    // something will always be there (we allocated enough memory
-    // for all of P, which is nonempty)
-    Free(myCandidatesToIterateThrough);
+    return 1;
+}
+
+/*! 
+    \param adjList An array of linked lists, representing the input graph in the
+                   "typical" adjacency list format.
+ 
+    \param adjacencyList an array of arrays, representing the input graph in a more
+                         compact and cache-friendly adjacency list format. (not currently used)
+
+    \param cliques A linked list of cliques to return. <b>(only available when compiled 
+                   with RETURN_CLIQUES_ONE_BY_ONE defined)</b>
+
+    \param degree An array, indexed by vertex, containing the degree of that vertex. (not currently used)
+
+    \param size The number of vertices in the graph.
+
+    \param degeneracy The degeneracy of the graph, which bounds the depth of the recursion.
+
+    \return the number of maximal cliques of the input graph.
+*/
+
+void listAllCliquesDegeneracy_E(count_t* cliqueCounts, 
+                                      OrientedGraph* orientedGraph,
+                                      int *ordering,
+                                      long *CSCindex,
+                                      int *CSCedges,
+                                      int size, int degeneracy, int min_k, int max_k,
+                                      count_t* withinCounts,
+                                      int bitsetBits, double bitsetDensity)
+{
+    PivotSearch* search = createPivotSearch(orientedGraph, size, degeneracy, cliqueCounts, min_k, max_k, bitsetBits, bitsetDensity);
+    search->ordering = ordering;
+    search->CSCindex = CSCindex;
+    search->CSCedges = CSCedges;
+    if (search->twins != NULL)
+        search->twins->withinCounts = withinCounts;
+
+    int beginX = 0;
+    int beginP = 0;
+    int beginR = size;
+
+    // for each vertex
+    for(int i=0;i<size;i++)
+    {
+        int vertex = i;
+        int newBeginX, newBeginP, newBeginR;
+
+        // set P to be later neighbors and X to be be earlier neighbors
+        // of vertex
+        fillInPandXForRecursiveCallDegeneracyCliques( vertex,
+                                               search->vertexSets, search->vertexLookup, 
+                                               orientedGraph,
+                                               search->neighborsInP, search->numNeighbors,
+                                               &beginX, &beginP, &beginR, 
+                                               &newBeginX, &newBeginP, &newBeginR,
+                                               search->arena);
+
+        // compute the cliques containing vertex, some of its later
+        // neighbors, and avoiding earlier neighbors
+        search->keepV[0] = vertex;
+        visitCall_E(search, newBeginX, newBeginP, newBeginR, 1, 0);
+        resumePivotSearch_E(search, -1);
+
+        beginR = beginR + 1;
+
+    }
+
+    destroyPivotSearch(search);
 
     return;
 }
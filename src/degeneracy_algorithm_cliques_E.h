@@ -43,19 +43,13 @@
 
 
 
-void listAllCliquesDegeneracyRecursive_E(double* cliqueCounts,
-                                               int *ordering,
-                                               int *CSCindex,
-                                               int *CSCedges,
-                                               int* vertexSets, int* vertexLookup,
-                                               int** neighborsInP, int* numNeighbors,
-                                               int beginX, int beginP, int beginR, int keep, int drop, int *keepV, int *dropV, int max_k);
-
-void listAllCliquesDegeneracy_E(double* cliqueCounts, 
-                                      NeighborListArray**,
+void listAllCliquesDegeneracy_E(count_t* cliqueCounts, 
+                                      OrientedGraph*,
                                       int *ordering,
-                                      int *CSCindex,
+                                      long *CSCindex,
                                       int *CSCedges,
-                                      int size, int max_k );
+                                      int size, int degeneracy, int min_k, int max_k,
+                                      count_t* withinCounts,
+                                      int bitsetBits, double bitsetDensity);
 
 #endif
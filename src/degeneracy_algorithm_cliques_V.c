@@ -37,9 +37,7 @@
 #include"MemoryManager.h"
 #include"degeneracy_helper.h"
 #include"degeneracy_algorithm_cliques_V.h"
-// #include"nCr.h"
 
-extern double nCr[1001][401];
 
 
 /*! \brief Computes the vertex v in P union X that has the most neighbors in P,
@@ -74,250 +72,340 @@ extern double nCr[1001][401];
 */
 
 
-/*!
+/*! \brief add the cliques a leaf of the recursion stands for on a graph
+           of twin classes to the counts of its vertices. Every vertex of a
+           class has the same counts, so the count of a class is that of
+           each of its vertices: fix one of them and let the rest of its
+           class be free.
 
-    \param adjList An array of linked lists, representing the input graph in the
-                   "typical" adjacency list format.
- 
-    \param adjacencyList an array of arrays, representing the input graph in a more
-                         compact and cache-friendly adjacency list format. (not currently used)
+    \param cliqueCounts the number of k-cliques of each vertex, for each k
+                        from min_k to max_k
 
-    \param cliques A linked list of cliques to return. <b>(only available when compiled 
-                   with RETURN_CLIQUES_ONE_BY_ONE defined)</b>
+    \param keepV the kept vertices
 
-    \param degree An array, indexed by vertex, containing the degree of that vertex. (not currently used)
+    \param keep the number of kept vertices
 
-    \param size The number of vertices in the graph.
+    \param dropV the dropped vertices
 
-    \return the number of maximal cliques of the input graph.
+    \param drop the number of dropped vertices
+
+    \param twins the weights and scratch space
+
+    \param min_k the smallest clique size to count
+
+    \param max_k the largest clique size to count
 */
 
-void listAllCliquesDegeneracy_V( double * cliqueCounts, NeighborListArray** orderingArray, 
-                                      int size, int max_k)
+static void addTwinCliques_V(count_t* cliqueCounts, int* keepV, int keep, int* dropV, int drop,
+                             TwinWeights* twins, int min_k, int max_k)
 {
+    int* weight = twins->weight;
+    long numK = max_k - min_k + 1;
+    int dropWeight = 0;
+    for (int j = 0; j < drop; j++)
+        dropWeight += weight[dropV[j]];
 
-    // vertex sets are stored in an array like this:
-    // |--X--|--P--|
-    int* vertexSets = (int *)Calloc(size, sizeof(int));
+    int lowest = twinKeepPolynomial(twins->keepPoly, keepV, keep, -1, -1, weight, max_k);
 
-    // vertex i is stored in vertexSets[vertexLookup[i]]
-    int* vertexLookup = (int *)Calloc(size, sizeof(int));
+    for (int k = max(lowest, min_k); k <= max_k; k++)
+    {
+        // a kept class of one vertex is in every clique of the leaf
+        count_t unitCliques = twinBinomialSum(twins->keepPoly, lowest, dropWeight, k);
+        count_t dropCliques = twinBinomialSum(twins->keepPoly, lowest, dropWeight - 1, k - 1);
 
-    int** neighborsInP = (int **)Calloc(size, sizeof(int*));
-    int* numNeighbors = (int *)Calloc(size, sizeof(int));
-    
-    int i = 0, deg = 0;
+        for (int j = 0; j < keep; j++)
+        {
+            if (weight[keepV[j]] == 1)
+                cliqueCounts[keepV[j]*numK + k - min_k] += unitCliques;
+        }
+        for (int j = 0; j < drop; j++)
+            cliqueCounts[dropV[j]*numK + k - min_k] += dropCliques;
+    }
 
-    while(i<size)
+    for (int j = 0; j < keep; j++)
     {
-        vertexLookup[i] = i;
-        vertexSets[i] = i;
-        neighborsInP[i] = (int *)Calloc(1, sizeof(int));
-        numNeighbors[i] = 1;
-        if ((int)orderingArray[i]->laterDegree > deg) deg = (int)orderingArray[i]->laterDegree;
-        i++;
+        int v = keepV[j];
+        if (weight[v] == 1) continue;
+
+        int otherLowest = twinKeepPolynomial(twins->otherPoly, keepV, keep, j, -1, weight, max_k);
+        for (int k = max(lowest, min_k); k <= max_k; k++)
+            cliqueCounts[v*numK + k - min_k] += twinBinomialSum(twins->otherPoly, otherLowest, dropWeight + weight[v] - 1, k - 1);
     }
+}
 
-    int beginX = 0;
-    int beginP = 0;
-    int beginR = size;
+/*! \brief add the cliques a leaf of the recursion stands for to the
+           counts of its vertices: R with any subset of the dropped (pivot)
+           vertices. A kept vertex is in all of them, a dropped one in
+           those that take it.
 
-    int* dropV = (int *)Calloc(MAX_CSIZE, sizeof(int));
-    int* keepV = (int *)Calloc(MAX_CSIZE, sizeof(int));
+    \param cliqueCounts the number of k-cliques of each vertex, for each k
+                        from min_k to max_k
 
-    // for each vertex
-    for(i=0;i<size;i++)
-    {
-        int vertex = (int)orderingArray[i]->vertex;
+    \param keep the number of kept vertices
 
-        int newBeginX, newBeginP, newBeginR;
+    \param drop the number of dropped vertices
 
-        // set P to be later neighbors and X to be be earlier neighbors
-        // of vertex
-        fillInPandXForRecursiveCallDegeneracyCliques( i, vertex, 
-                                               vertexSets, vertexLookup, 
-                                               orderingArray,
-                                               neighborsInP, numNeighbors,
-                                               &beginX, &beginP, &beginR, 
-                                               &newBeginX, &newBeginP, &newBeginR);
+    \param keepV the kept vertices
 
+    \param dropV the dropped vertices
 
-        // recursively compute maximal cliques containing vertex, some of its
-        // later neighbors, and avoiding earlier neighbors
-        int drop = 0;
-        int keep = 1;
-        memset(keepV, 0, MAX_CSIZE);
-        memset(dropV, 0, MAX_CSIZE);
-        keepV[keep-1] = vertex;
-        listAllCliquesDegeneracyRecursive_V(cliqueCounts,
-                                                  vertexSets, vertexLookup,
-                                                  neighborsInP, numNeighbors,
-                                                  newBeginX, newBeginP, newBeginR, keep, drop, keepV, dropV, max_k); 
+    \param twins the weights and scratch space, or NULL
 
-        beginR = beginR + 1;
+    \param min_k the smallest clique size to count
 
+    \param max_k the largest clique size to count
+*/
+
+static void addCliques_V(count_t* cliqueCounts, int keep, int drop, int* keepV, int* dropV,
+                         TwinWeights* twins, int min_k, int max_k)
+{
+    if (twins != NULL)
+    {
+        addTwinCliques_V(cliqueCounts, keepV, keep, dropV, drop, twins, min_k, max_k);
+        return;
     }
-    
-    Free(vertexSets);
-    Free(vertexLookup);
 
-    for(i = 0; i<size; i++)
+    long numK = max_k - min_k + 1;
+    count_t kkeepCliques = 0; // number of kcliques a vertex from "keep" is involved in
+    for (int i=min(drop, keep+drop-min_k); (i>=0) && (keep+drop-i <= max_k); i--) 
+    {
+        int k = keep + drop - i;
+        kkeepCliques = nCr[drop][i];
+        for (int j=0; j<keep; j++)
+        {
+            int v = keepV[j];
+            cliqueCounts[v*numK + k - min_k] += kkeepCliques;
+        }
+    }
+    count_t kdropCliques = 0;
+    for (int i=min(drop-1, keep+drop-min_k); (i>=0) && (keep+drop-i <= max_k); i--) 
     {
-        Free(neighborsInP[i]);
-        Free(orderingArray[i]->later);
-        Free(orderingArray[i]->earlier);
-        Free(orderingArray[i]);
+        int k = keep + drop - i;
+        kdropCliques = nCr[drop-1][i];
+        for (int j=0; j<drop; j++)
+        {
+            int v = dropV[j];
+            cliqueCounts[v*numK + k - min_k] += kdropCliques;
+        }
     }
+}
 
-    Free(neighborsInP);
-    Free(numNeighbors);
+static void listAllCliquesBitsetRecursive_V(count_t* cliqueCounts, BitsetGraph* bitset, const uint64_t* setP,
+                                            int keep, int drop, int* keepV, int* dropV, int min_k, int max_k,
+                                            TwinWeights* twins);
 
-    return;
+/*! \brief branch on the candidates of a call whose P is a bitset: the
+           vertices of P that are not neighbors of the pivot. Each one is
+           added to R with P cut down to its neighbors, and then leaves P.
+
+    \param cliqueCounts the number of k-cliques of each vertex, for each k
+                        from min_k to max_k
+
+    \param bitset the bit matrix P was labeled in
+
+    \param setP P, which is not empty
+
+    The rest are as in visitCall_V.
+*/
+
+static void expandBitset_V(count_t* cliqueCounts, BitsetGraph* bitset, const uint64_t* setP,
+                           int keep, int drop, int* keepV, int* dropV, int min_k, int max_k,
+                           TwinWeights* twins)
+{
+    int numWords = bitset->numWords;
+    int pivot = findBestPivotBitset(bitset, setP);
+
+    uint64_t remaining[BITSET_WORDS];
+    uint64_t newP[BITSET_WORDS];
+
+    for (int w = 0; w < numWords; w++)
+        remaining[w] = setP[w];
+
+    for (int w = 0; w < numWords; w++)
+    {
+        uint64_t word = setP[w] & ~bitset->adjacency[pivot][w];
+        while (word != 0)
+        {
+            int label = 64*w + __builtin_ctzll(word);
+            const uint64_t* row = bitset->adjacency[label];
+
+            remaining[w] &= ~(1ULL << (label%64));
+            for (int x = 0; x < numWords; x++)
+                newP[x] = remaining[x] & row[x];
+
+            if (label == pivot)
+            {
+                dropV[drop] = bitset->vertex[label];
+                listAllCliquesBitsetRecursive_V(cliqueCounts, bitset, newP, keep, drop+1, keepV, dropV, min_k, max_k, twins);
+            }
+            else
+            {
+                keepV[keep] = bitset->vertex[label];
+                listAllCliquesBitsetRecursive_V(cliqueCounts, bitset, newP, keep+1, drop, keepV, dropV, min_k, max_k, twins);
+            }
+
+            word &= word - 1;
+        }
+    }
 }
 
-/*! \brief Recursively list all maximal cliques containing all of
-           all vertices in R, some vertices in P and no vertices in X.
+/*! \brief visitCall_V for a P that has moved to
+           bitsets; every call below it stays on bitsets.
+*/
 
-    \param cliqueCount A pointer to the number of maximal cliques computed 
-                       thus far.
+static void listAllCliquesBitsetRecursive_V(count_t* cliqueCounts, BitsetGraph* bitset, const uint64_t* setP,
+                                            int keep, int drop, int* keepV, int* dropV, int min_k, int max_k,
+                                            TwinWeights* twins)
+{
+    int sizeOfP = bitsetCount(setP, bitset->numWords);
 
-    \param cliques A linked list of cliques to return. <b>(only available when compiled 
-                   with RETURN_CLIQUES_ONE_BY_ONE defined)</b>
+    if ((twins == NULL) && (keep + drop + sizeOfP < min_k))
+        return;
 
-    \param partialClique A linked list storing R, the partial clique for this
-                         recursive call. 
+    if ((sizeOfP == 0) || (keep > max_k))
+    {
+        addCliques_V(cliqueCounts, keep, drop, keepV, dropV, twins, min_k, max_k);
+        return;
+    }
 
-    \param vertexSets An array containing sets of vertices divided into sets X, P, R and other.
- 
-    \param vertexLookup A lookup table indexed by vertex number, storing the index of that 
-                        vertex in vertexSets.
+    expandBitset_V(cliqueCounts, bitset, setP, keep, drop, keepV, dropV, min_k, max_k, twins);
+}
 
-    \param neighborsInP Maps vertices to arrays of neighbors such that 
-                        neighbors in P fill the first cells
+/*! \brief visit a call of the recursion: add the cliques of a leaf,
+           finish a small P on bitsets, or push a frame to branch on its
+           candidates.
 
-    \param numNeighbors An the neighbor of neighbors a vertex had in P,
-                        the first time this function is called, this bound is 
-                        used to keep us from allocating more than linear space.
+    \param search the search
 
     \param beginX The index where set X begins in vertexSets.
- 
+
     \param beginP The index where set P begins in vertexSets.
 
     \param beginR The index where set R begins in vertexSets.
 
+    \param keep the number of vertices of R that are not pivots
+
+    \param drop the number of pivots in R
 */
 
-void listAllCliquesDegeneracyRecursive_V( double * cliqueCounts,
-                                               int* vertexSets, int* vertexLookup,
-                                               int** neighborsInP, int* numNeighbors,
-                                               int beginX, int beginP, int beginR, int keep, int drop, int *keepV, int *dropV, int max_k)
+static void visitCall_V(PivotSearch* search, int beginX, int beginP, int beginR, int keep, int drop)
 {
-    if ((beginP >= beginR) || (keep > max_k))
+    // no clique below here is large enough to count (a class of twins
+    // may stand for several vertices, so only without twins)
+    if ((search->twins == NULL) && (keep + drop + (beginR - beginP) < search->min_k))
+        return;
+
+    if ((beginP >= beginR) || (keep > search->max_k))
     {
-        double kkeepCliques = 0; // number of kcliques a vertex from "keep" is involved in
-        for (int i=drop; (i>=0) && (keep+drop-i <= max_k); i--) 
-        {
-            int k = keep + drop - i;
-            kkeepCliques = nCr[drop][i];
-            for (int j=0; j<keep; j++)
-            {
-                int v = keepV[j];
-                cliqueCounts[v*(max_k+1)+k] += kkeepCliques;
-            }
-        }
-        double kdropCliques = 0;
-        for (int i=drop-1; (i>=0) && (keep+drop-i <= max_k); i--) 
-        {
-            int k = keep + drop - i;
-            kdropCliques = nCr[drop-1][i];
-            for (int j=0; j<drop; j++)
-            {
-                int v = dropV[j];
-                cliqueCounts[v*(max_k+1)+k] += kdropCliques;
-            }
-        }
+        addCliques_V(search->cliqueCounts, keep, drop, search->keepV, search->dropV,
+                     search->twins, search->min_k, search->max_k);
+        return;
+    }
+
+    // a small, dense P goes on with bitsets, all the way down
+    uint64_t setP[BITSET_WORDS];
+    if ((search->bitset != NULL) && fillInBitsetForRecursiveCall(search->bitset, search->vertexSets, search->vertexLookup,
+                                                                 search->neighborsInP, search->numNeighbors,
+                                                                 beginP, beginR, setP))
+    {
+        expandBitset_V(search->cliqueCounts, search->bitset, setP, keep, drop, search->keepV, search->dropV,
+                       search->min_k, search->max_k, search->twins);
         return;
     }
-    
-    int* myCandidatesToIterateThrough;
-    int numCandidatesToIterateThrough;
 
-    // get the candidates to add to R to make a maximal clique
-    int pivot = findBestPivotNonNeighborsDegeneracyCliques( &myCandidatesToIterateThrough,
-                                         &numCandidatesToIterateThrough,
-                                         vertexSets, vertexLookup,
-                                         neighborsInP, numNeighbors,
-                                         beginX, beginP, beginR);
+    pushPivotFrame(search, beginX, beginP, beginR, keep, drop);
+}
 
-    
+/*! \brief run the recursion from the frames of a search, for at most a
+           number of calls. A P that moved to bitsets is finished in one
+           call.
+
+    \param search the search, from a root visited with visitCall_V
 
-    // add candiate vertices to the partial clique one at a time and 
-    // search for maximal cliques
-    if(numCandidatesToIterateThrough != 0)
+    \param maxCalls the largest number of calls to visit, or -1 for no limit
+
+    \return 1 if the search is done (it has no frames left), or 0 if it
+            stopped at maxCalls. Calling it again goes on where it stopped.
+*/
+
+static int resumePivotSearch_V(PivotSearch* search, long maxCalls)
+{
+    long calls = 0;
+
+    while (search->depth > 0)
     {
-        int iterator = 0;
-        while(iterator < numCandidatesToIterateThrough)
+        if (calls == maxCalls)
+            return 0;
+
+        int newBeginX, newBeginP, newBeginR, keep, drop;
+        if (nextPivotCall(search, &newBeginX, &newBeginP, &newBeginR, &keep, &drop))
         {
-            // vertex to be added to the partial clique
-            int vertex = myCandidatesToIterateThrough[iterator];
+            visitCall_V(search, newBeginX, newBeginP, newBeginR, keep, drop);
+            calls++;
+        }
+    }
+
+    return 1;
+}
 
-            int newBeginX, newBeginP, newBeginR;
+/*!
 
-            // swap vertex into R and update all data structures 
-            moveToRDegeneracyCliques( vertex, 
-                               vertexSets, vertexLookup, 
-                               neighborsInP, numNeighbors,
-                               &beginX, &beginP, &beginR, 
-                               &newBeginX, &newBeginP, &newBeginR);
+    \param adjList An array of linked lists, representing the input graph in the
+                   "typical" adjacency list format.
+ 
+    \param adjacencyList an array of arrays, representing the input graph in a more
+                         compact and cache-friendly adjacency list format. (not currently used)
 
+    \param cliques A linked list of cliques to return. <b>(only available when compiled 
+                   with RETURN_CLIQUES_ONE_BY_ONE defined)</b>
 
-            
-            // recursively compute maximal cliques with new sets R, P and X
-            if (vertex == pivot)
-            {
-                dropV[drop] = vertex;
-                listAllCliquesDegeneracyRecursive_V(cliqueCounts,
-                                                      vertexSets, vertexLookup,
-                                                      neighborsInP, numNeighbors,
-                                                      newBeginX, newBeginP, newBeginR, keep, drop+1, keepV, dropV, max_k);
-            }
-            else
-            {
-                keepV[keep] = vertex;
-                listAllCliquesDegeneracyRecursive_V(cliqueCounts,
-                                                      vertexSets, vertexLookup,
-                                                      neighborsInP, numNeighbors,
-                                                      newBeginX, newBeginP, newBeginR, keep+1, drop, keepV, dropV, max_k);
-            }
+    \param degree An array, indexed by vertex, containing the degree of that vertex. (not currently used)
 
-            moveFromRToXDegeneracyCliques( vertex, 
-                                    vertexSets, vertexLookup,
-                                    &beginX, &beginP, &beginR );
+    \param size The number of vertices in the graph.
 
-            iterator++;
-        }
+    \param degeneracy The degeneracy of the graph, which bounds the depth of the recursion.
 
-        // swap vertices that were moved to X back into P, for higher recursive calls.
-        iterator = 0;
-        while(iterator < numCandidatesToIterateThrough)
-        {
-            int vertex = myCandidatesToIterateThrough[iterator];
-            int vertexLocation = vertexLookup[vertex];
+    \return the number of maximal cliques of the input graph.
+*/
 
-            beginP--;
-            vertexSets[vertexLocation] = vertexSets[beginP];
-            vertexSets[beginP] = vertex;
-            vertexLookup[vertex] = beginP;
-            vertexLookup[vertexSets[vertexLocation]] = vertexLocation;
+void listAllCliquesDegeneracy_V( count_t * cliqueCounts, OrientedGraph* orientedGraph, 
+                                      int size, int degeneracy, int min_k, int max_k,
+                                      int bitsetBits, double bitsetDensity)
+{
+    PivotSearch* search = createPivotSearch(orientedGraph, size, degeneracy, cliqueCounts, min_k, max_k, bitsetBits, bitsetDensity);
+
+    int beginX = 0;
+    int beginP = 0;
+    int beginR = size;
+
+    // for each vertex
+    for(int i=0;i<size;i++)
+    {
+        int vertex = i;
+
+        int newBeginX, newBeginP, newBeginR;
+
+        // set P to be later neighbors and X to be be earlier neighbors
+        // of vertex
+        fillInPandXForRecursiveCallDegeneracyCliques( vertex,
+                                               search->vertexSets, search->vertexLookup, 
+                                               orientedGraph,
+                                               search->neighborsInP, search->numNeighbors,
+                                               &beginX, &beginP, &beginR, 
+                                               &newBeginX, &newBeginP, &newBeginR,
+                                               search->arena);
+
+        // compute the cliques containing vertex, some of its later
+        // neighbors, and avoiding earlier neighbors
+        search->keepV[0] = vertex;
+        visitCall_V(search, newBeginX, newBeginP, newBeginR, 1, 0);
+        resumePivotSearch_V(search, -1);
+
+        beginR = beginR + 1;
 
-            iterator++;
-        }
     }
 
-    // don't need to check for emptiness before freeing, since
-    // something will always be there (we allocated enough memory
-    // for all of P, which is nonempty)
-    Free(myCandidatesToIterateThrough);
+    destroyPivotSearch(search);
 
     return;
 }
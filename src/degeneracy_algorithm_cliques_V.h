@@ -42,12 +42,8 @@
 
 
 
-void listAllCliquesDegeneracyRecursive_V(double *,
-                                               int* vertexSets, int* vertexLookup,
-                                               int** neighborsInP, int* numNeighbors,
-                                               int beginX, int beginP, int beginR, int keep, int drop, int *keepV, int *dropV, int max_k);
-
-void listAllCliquesDegeneracy_V(double *, NeighborListArray**,
-                                      int size, int max_k );
+void listAllCliquesDegeneracy_V(count_t *, OrientedGraph*,
+                                      int size, int degeneracy, int min_k, int max_k,
+                                      int bitsetBits, double bitsetDensity);
 
 #endif
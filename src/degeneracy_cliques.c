@@ -33,41 +33,70 @@
 #include<time.h>
 #include<limits.h>
 #include<unistd.h> 
+#include<getopt.h>
 #include<libgen.h>
     
 #include"misc.h"
 #include"LinkedList.h"
 #include"MemoryManager.h"
+#include"graph_ingest.h"
 
 
 
 int main(int argc,char** argv)
 {
 
-    if (argc != 11)
+    if ((argc < 11) || (argc % 2 == 0))
     {
         printf("Incorrect number of arguments.\n");
-        printf("./degeneracy_cliques -i <file_path> -t <type> -k <max_clique_size> -d <data_flag> -o <optimize>\n");
-        printf("file_path: path to file\n");
+        printf("./degeneracy_cliques -i <file_path> -t <type> -k <max_clique_size> [-kmin <min_clique_size>] -d <data_flag> -o <relabel> [-f <format>] [-c <compress>] [-e <epsilon>] [-r <ordering>] [-w <order_file>] [-l <order_file>] [-x <twins>] [-b <bits>] [-bdensity <density>] [-simd <kernels>]\n");
+        printf("file_path: path to file, or a directory or quoted glob pattern of shards\n");
         printf("type: A/V/E. A for just k-clique information, V for per-vertex k-cliques, E for per-edge k-cliques\n");
-        printf("max_clique_size: max_clique_size. If 0, calculate for all k.\n");
+        printf("max_clique_size: max_clique_size, also given as -kmax. If 0, calculate for all k.\n");
+        printf("min_clique_size: only count cliques of at least this size (default 0), after dropping the vertices that cannot be in one.\n");
         printf("data_flag: 1 if information is to be output to a file, 0 otherwise.\n");
-        printf("optimize: 1 if you want to use near clique new code or 0 for old method.\n");
+        printf("relabel: 1 to rename the vertices by their position in the ordering for locality, 0 to keep the input names. Output always uses the input names.\n");
+        printf("format: edges (default), snap, csv, mtx or metis. snap and csv ids may be arbitrary and are mapped to 0..n-1.\n");
+        printf("compress: 1 to keep the oriented adjacency lists delta + varint compressed, 0 (default) for plain arrays.\n");
+        printf("epsilon: if above 0 (default 0), use a parallel (1+epsilon)-approximate degeneracy ordering instead of the exact one.\n");
+        printf("ordering: degen (default), degree, degen-degree, degen-id, color, or auto to pick the one with the cheapest recursion on a sample of vertices.\n");
+        printf("order_file: -w writes the vertex ordering to this file, -l loads it from there instead of computing it, if it was written for the same graph.\n");
+        printf("bits: 64, 128 or 256 to continue the recursion on bitsets once P has at most that many vertices (default %d), 0 to stay on arrays.\n", BITSET_DEFAULT_BITS);
+        printf("density: the smallest fraction of possible edges P must have to move to bitsets (default %g).\n", BITSET_DEFAULT_DENSITY);
+        printf("kernels: auto (default), scalar, avx2 or avx512, the instruction set of the inner loops. auto picks the best one this CPU supports.\n");
+        printf("twins: 1 to collapse vertices with the same closed neighborhood into one weighted vertex before counting, 0 (default) to count on the graph as given.\n");
         return 0;
     }
 
-    int n; // number of vertices
-    int m; // 2x number of edges
-
     // char *opt = NULL;
     int opt;
     char *fpath = (char *)Calloc(1000, sizeof(char));
     char t;
     int flag_d;
     int max_k = 0;
+    int min_k = 0;
     int flag_o;
+    int format = FORMAT_EDGES;
+    int flag_c = 0;
+    int flag_twins = 0;
+    int bitsetBits = BITSET_DEFAULT_BITS;
+    double bitsetDensity = BITSET_DEFAULT_DENSITY;
+    int simd = SET_KERNELS_AUTO;
+    double epsilon = 0;
+    int order = ORDER_DEGENERACY;
+    char *orderIn = NULL;
+    char *orderOut = NULL;
+
+    // -kmin and -kmax are long options that, like the rest, take a single dash
+    struct option longOptions[] = {
+        {"kmin", required_argument, NULL, 'K'},
+        {"kmax", required_argument, NULL, 'k'},
+        {"bdensity", required_argument, NULL, 'D'},
+        {"simd", required_argument, NULL, 'S'},
+        {NULL, 0, NULL, 0}
+    };
 
-    while((opt = getopt(argc, argv, ":i:t:k:d:o:")) != -1)  
+    while((opt = getopt_long_only(argc, argv, ":i:t:k:d:o:f:c:e:r:w:l:x:b:", longOptions, NULL)) != -1)  
     {  
         switch(opt)  
         {  
@@ -88,6 +117,14 @@ int main(int argc,char** argv)
             case 'k':  
                 max_k = atoi(optarg);
                 break;
+            case 'K':
+                min_k = atoi(optarg);
+                if (min_k < 0)
+                {
+                    printf("Incorrect min_clique_size. Should be 0 or more\n");
+                    return 0;
+                }
+                break;
             case 'd': 
                 flag_d = atoi(optarg);
                 if ((flag_d < 0) || (flag_d > 2))
@@ -104,6 +141,76 @@ int main(int argc,char** argv)
                     return 0;
                 }
                 break;
+            case 'f':
+                format = parseGraphFormat(optarg);
+                if (format < 0)
+                {
+                    printf("Incorrect format. Format should be edges, snap, csv, mtx or metis.\n");
+                    return 0;
+                }
+                break;
+            case 'c':
+                flag_c = atoi(optarg);
+                if ((flag_c < 0) || (flag_c > 1))
+                {
+                    printf("Incorrect flag for compression. Should be 0 or 1\n");
+                    return 0;
+                }
+                break;
+            case 'e':
+                epsilon = atof(optarg);
+                if (epsilon < 0)
+                {
+                    printf("Incorrect epsilon. Should be 0 or more\n");
+                    return 0;
+                }
+                break;
+            case 'r':
+                order = parseVertexOrder(optarg);
+                if (order < 0)
+                {
+                    printf("Incorrect ordering. Ordering should be degen, degree, degen-degree, degen-id, color or auto.\n");
+                    return 0;
+                }
+                break;
+            case 'w':
+                orderOut = optarg;
+                break;
+            case 'l':
+                orderIn = optarg;
+                break;
+            case 'x':
+                flag_twins = atoi(optarg);
+                if ((flag_twins < 0) || (flag_twins > 1))
+                {
+                    printf("Incorrect flag for twins. Should be 0 or 1\n");
+                    return 0;
+                }
+                break;
+            case 'b':
+                bitsetBits = atoi(optarg);
+                if ((bitsetBits != 0) && (bitsetBits != 64) && (bitsetBits != 128) && (bitsetBits != 256))
+                {
+                    printf("Incorrect number of bits. Should be 0, 64, 128 or 256\n");
+                    return 0;
+                }
+                break;
+            case 'D':
+                bitsetDensity = atof(optarg);
+                if ((bitsetDensity < 0) || (bitsetDensity > 1))
+                {
+                    printf("Incorrect density. Should be between 0 and 1\n");
+                    return 0;
+                }
+                break;
+            case 'S':
+                simd = parseSetKernels(optarg);
+                if (simd < SET_KERNELS_AUTO)
+                {
+                    printf("Incorrect kernels. Should be auto, scalar, avx2 or avx512\n");
+                    return 0;
+                }
+                break;
             default:
                 printf("In default case.\n");
                 abort ();
@@ -111,32 +218,57 @@ int main(int argc,char** argv)
     }
     
 
+    if ((max_k > 0) && (min_k > max_k))
+    {
+        printf("min_clique_size (-kmin) cannot be above max_clique_size.\n");
+        return 0;
+    }
+
+    if ((epsilon > 0) && (order != ORDER_DEGENERACY))
+    {
+        printf("An approximate ordering (-e) can only be used with the degen ordering.\n");
+        return 0;
+    }
+
     printf("New code.\n");
+    selectSetKernels(simd);
+    printf("Using the %s set kernels.\n", setKernels.name);
     // printf("Parsed all arguments. t = %c, max_k = %d, flag_d = %d. About to get graph.\n", t, max_k, flag_d);
-    LinkedList** adjacencyList = readInGraphAdjListToDoubleEdges(&n, &m, fpath);
-
-    int i;
+    CSRGraph* graph = loadGraphCSR(fpath, format);
 
     char *gname = basename(fpath);
+    char *shardName = NULL;
+
+    // name the results after the directory of a glob pattern of shards
+    if (strpbrk(gname, "*?[") != NULL)
+    {
+        char *dir = (char *)Calloc(strlen(fpath) + 1, sizeof(char));
+        strcpy(dir, fpath);
+
+        // dirname may return a constant "." instead of editing dir, and
+        // "." names nothing, so name the results after the real path
+        char *parent = dirname(dir);
+        char *resolved = realpath(parent, NULL);
+        char *name = basename((resolved != NULL) ? resolved : parent);
+
+        shardName = (char *)Calloc(strlen(name) + 1, sizeof(char));
+        strcpy(shardName, name);
+        gname = shardName;
+
+        free(resolved);
+        Free(dir);
+    }
 
     char *lastdot = strrchr (gname, '.');
     if (lastdot != NULL)
         *lastdot = '\0';
 
 
-    populate_nCr();
     printf("about to call runAndPrint.\n");
-    runAndPrintStatsCliques(adjacencyList, n, gname, t, max_k, flag_d, flag_o);
-
-
-    i = 0;
-    while(i<n)
-    {
-        destroyLinkedList(adjacencyList[i]);
-        i++;
-    }
+    runAndPrintStatsCliques(graph, gname, t, min_k, max_k, flag_d, flag_o, flag_c, flag_twins, bitsetBits, bitsetDensity, epsilon, order, orderIn, orderOut);
 
-    Free(adjacencyList); 
+    destroyCSRGraph(graph);
+    if (shardName != NULL) Free(shardName);
 
     return 0;
 }
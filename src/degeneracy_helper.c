@@ -30,6 +30,8 @@
 #include<assert.h>
 #include<stdio.h>
 #include<stdlib.h>
+#include<string.h>
+#include<pthread.h>
 
 #include"misc.h"
 #include"LinkedList.h"
@@ -41,102 +43,108 @@ int qsortComparator(const void *node1, const void *node2)
     return (*(int *)node1 - *(int *)node2);
 }
 
-/*! \brief
+/*! \brief peel the graph in degeneracy order with the bin sort of
+           Batagelj and Zaversnik: the vertices are kept in one array
+           sorted by current degree, and moving a neighbor down one bin is
+           a swap with the first vertex of its bin, so the whole ordering
+           takes O(n+m) time and no allocation per edge.
+
+    \param graph an input graph, in compressed sparse row format
 
-    \param list an input graph, represented as an array of linked lists of integers
+    \param ordering an array of size graph->n, filled with the vertices in
+                    the order they are removed
 
-    \param size the number of vertices in the graph
+    \param position an array of size graph->n, filled with the index of
+                    each vertex in ordering
 
     \return the degeneracy of the input graph.
 */
 
-int computeDegeneracy(LinkedList** list, int size)
+int computeDegeneracyPeeling(CSRGraph* graph, int* ordering, int* position)
 {
+    int size = graph->n;
     int i = 0;
 
     int degeneracy = 0;
-    
-    // array of lists of vertices, indexed by degree
-    LinkedList** verticesByDegree = (LinkedList**) Calloc(size, sizeof(LinkedList*));
+    int maxDegree = 0;
 
-    // array of lists of vertices, indexed by degree
-    Link** vertexLocator = (Link**) Calloc(size, sizeof(Link*));
+    int* degree = (int*) Calloc(max(size, 1), sizeof(int));
 
-    int* degree = (int*) Calloc(size, sizeof(int));
-
-    for(i = 0; i < size; i++)
+    for(i=0; i<size; i++)
     {
-        verticesByDegree[i] = createLinkedList();
+        degree[i] = (int)(graph->offsets[i+1] - graph->offsets[i]);
+        maxDegree = max(maxDegree, degree[i]);
     }
 
-    // fill each cell of degree lookup table
-    // then use that degree to populate the 
-    // lists of vertices indexed by degree
+    // binStart[d] is the index in ordering of the first vertex with degree d
+    int* binStart = (int*) Calloc(maxDegree + 1, sizeof(int));
 
     for(i=0; i<size; i++)
     {
-        degree[i] = length(list[i]);
-        vertexLocator[i] = addFirst(verticesByDegree[degree[i]], ((int) i));
+        binStart[degree[i]]++;
     }
-    
-    int currentDegree = 0;
 
-    int numVerticesRemoved = 0;
+    int start = 0;
+    int d = 0;
+    for(d=0; d<=maxDegree; d++)
+    {
+        int binSize = binStart[d];
+        binStart[d] = start;
+        start += binSize;
+    }
 
-    while(numVerticesRemoved < size)
+    for(i=0; i<size; i++)
     {
-        if(!isEmpty(verticesByDegree[currentDegree]))
-        {
-            degeneracy = max(degeneracy,currentDegree);
-            
-            int vertex = (int)(size_t) getFirst(verticesByDegree[currentDegree]);
+        position[i] = binStart[degree[i]]++;
+        ordering[position[i]] = i;
+    }
+
+    for(d=maxDegree; d>0; d--)
+    {
+        binStart[d] = binStart[d-1];
+    }
+    binStart[0] = 0;
 
-            deleteLink(vertexLocator[vertex]);
+    // ordering[i] has the smallest degree of the vertices not yet removed,
+    // which is its core number
+    for(i=0; i<size; i++)
+    {
+        int vertex = ordering[i];
 
-            degree[vertex] = -1;
+        degeneracy = max(degeneracy, degree[vertex]);
 
-            LinkedList* neighborList = list[vertex];
+        long neighborIndex = graph->offsets[vertex];
 
-            Link* neighborLink = neighborList->head->next;
+        while(neighborIndex < graph->offsets[vertex+1])
+        {
+            int neighbor = graph->neighbors[neighborIndex];
 
-            while(!isTail(neighborLink))
+            if(degree[neighbor] > degree[vertex])
             {
-                int neighbor = (int)(size_t) neighborLink->data;
-
-                if(degree[neighbor]!=-1)
+                // swap neighbor with the first vertex of its bin,
+                // then shrink the bin past it
+                int neighborDegree = degree[neighbor];
+                int neighborPosition = position[neighbor];
+                int firstPosition = binStart[neighborDegree];
+                int first = ordering[firstPosition];
+
+                if(neighbor != first)
                 {
-                    deleteLink(vertexLocator[neighbor]);
-
-                    degree[neighbor]--;
-
-                    if(degree[neighbor] != -1)
-                    {
-                        vertexLocator[neighbor] = 
-                            addFirst(verticesByDegree[degree[neighbor]], 
-                                     (int) neighbor);
-                    }
+                    ordering[neighborPosition] = first;
+                    position[first] = neighborPosition;
+                    ordering[firstPosition] = neighbor;
+                    position[neighbor] = firstPosition;
                 }
 
-                neighborLink = neighborLink->next;
+                binStart[neighborDegree]++;
+                degree[neighbor]--;
             }
 
-            numVerticesRemoved++;
-            currentDegree = 0;
-        }
-        else
-        {
-            currentDegree++;
+            neighborIndex++;
         }
-
-    }
-
-    for(i = 0; i<size;i++)
-    {
-        destroyLinkedList(verticesByDegree[i]);
     }
 
-    Free(vertexLocator);
-    Free(verticesByDegree);
+    Free(binStart);
     Free(degree);
 
     return degeneracy;
@@ -144,456 +152,1120 @@ int computeDegeneracy(LinkedList** list, int size)
 
 /*! \brief
 
-    \param list an input graph, represented as an array of linked lists of integers
-
-    \param size the number of vertices in the graph
-
-    \return an array of NeighborLists representing a degeneracy ordering of the vertices.
+    \param graph an input graph, in compressed sparse row format
 
-    \see NeighborList
+    \return the degeneracy of the input graph.
 */
 
-NeighborList** computeDegeneracyOrderList(LinkedList** list, int size)
+int computeDegeneracy(CSRGraph* graph)
 {
+    int size = graph->n;
 
-#ifdef DEBUG
-    printf("degeneracy is %d\n", computeDegeneracy(list, size));
-#endif
+    int* ordering = (int*) Calloc(max(size, 1), sizeof(int));
+    int* position = (int*) Calloc(max(size, 1), sizeof(int));
 
-    NeighborList** ordering = (NeighborList**)Calloc(size, sizeof(NeighborList*));
+    int degeneracy = computeDegeneracyPeeling(graph, ordering, position);
 
-    int i = 0;
+    Free(ordering);
+    Free(position);
 
-    int degeneracy = 0;
-    
-    // array of lists of vertices, indexed by degree
-    LinkedList** verticesByDegree = (LinkedList**) Calloc(size, sizeof(LinkedList*));
+    return degeneracy;
+}
+
+/*! \brief build the OrientedGraph of a vertex ordering.
+
+    \param graph an input graph, in compressed sparse row format
+
+    \param ordering the vertices in order
+
+    \param position the index of each vertex in ordering
+
+    \param renumber 1 to rename every vertex to its position and sort the
+                    neighbor lists, 0 to keep the original names and the
+                    order of the adjacency lists. Renamed graphs keep a copy
+                    of ordering in originalName to translate names back.
 
-    // array of lists of vertices, indexed by degree
-    Link** vertexLocator = (Link**) Calloc(size, sizeof(Link*));
+    \return the graph with every edge split into a later and an earlier neighbor.
+*/
+
+OrientedGraph* computeOrientedGraph(CSRGraph* graph, int* ordering, int* position, int renumber)
+{
+    int size = graph->n;
+    int i = 0;
 
-    int* degree = (int*) Calloc(size, sizeof(int));
+    OrientedGraph* orientedGraph = (OrientedGraph*)Calloc(1, sizeof(OrientedGraph));
+    orientedGraph->n = size;
+    orientedGraph->m = graph->m/2;
+    orientedGraph->orderNumber = (int*)Calloc(max(size, 1), sizeof(int));
+    orientedGraph->laterOffsets = (long*)Calloc(size + 1, sizeof(long));
+    orientedGraph->earlierOffsets = (long*)Calloc(size + 1, sizeof(long));
 
-    for(i = 0; i < size; i++)
+    if (renumber)
     {
-        verticesByDegree[i] = createLinkedList();
-        ordering[i] = (NeighborList*)Malloc(sizeof(NeighborList));
-        ordering[i]->earlier = createLinkedList();
-        ordering[i]->later = createLinkedList();
+        orientedGraph->originalName = (int*)Malloc(max(size, 1)*sizeof(int));
+        memcpy(orientedGraph->originalName, ordering, size*sizeof(int));
     }
 
-    // fill each cell of degree lookup table
-    // then use that degree to populate the 
-    // lists of vertices indexed by degree
+    // count the later and earlier neighbors of every vertex under its new name
+    for (i = 0; i < size; i++)
+    {
+        int name = renumber ? position[i] : i;
+        int later = 0;
+        long neighborIndex = 0;
+
+        for (neighborIndex = graph->offsets[i]; neighborIndex < graph->offsets[i+1]; neighborIndex++)
+        {
+            if (position[graph->neighbors[neighborIndex]] > position[i])
+                later++;
+        }
+
+        orientedGraph->orderNumber[name] = position[i];
+        orientedGraph->laterOffsets[name+1] = later;
+        orientedGraph->earlierOffsets[name+1] = (graph->offsets[i+1] - graph->offsets[i]) - later;
+    }
 
-    for(i=0; i<size; i++)
+    for (i = 0; i < size; i++)
     {
-        degree[i] = length(list[i]);
-        //printf("degree[%d] = %d\n", i, degree[i]);
-        vertexLocator[i] = addFirst(verticesByDegree[degree[i]], ((int) i));
+        orientedGraph->laterOffsets[i+1] += orientedGraph->laterOffsets[i];
+        orientedGraph->earlierOffsets[i+1] += orientedGraph->earlierOffsets[i];
     }
-    
-    int currentDegree = 0;
 
-    int numVerticesRemoved = 0;
+    orientedGraph->later = (int*)Malloc(max(orientedGraph->m, 1)*sizeof(int));
+    orientedGraph->earlier = (int*)Malloc(max(orientedGraph->m, 1)*sizeof(int));
 
-    while(numVerticesRemoved < size)
+    for (i = 0; i < size; i++)
     {
-        if(!isEmpty(verticesByDegree[currentDegree]))
+        int name = renumber ? position[i] : i;
+        int* later = orientedGraph->later + orientedGraph->laterOffsets[name];
+        int* earlier = orientedGraph->earlier + orientedGraph->earlierOffsets[name];
+        long neighborIndex = 0;
+
+        for (neighborIndex = graph->offsets[i]; neighborIndex < graph->offsets[i+1]; neighborIndex++)
         {
-            degeneracy = max(degeneracy,currentDegree);
-            
-            int vertex = (int)(size_t) getFirst(verticesByDegree[currentDegree]);
+            int neighbor = graph->neighbors[neighborIndex];
+            int neighborName = renumber ? position[neighbor] : neighbor;
 
-            deleteLink(vertexLocator[vertex]);
+            if (position[neighbor] > position[i])
+                *later++ = neighborName;
+            else
+                *earlier++ = neighborName;
+        }
 
-            ordering[vertex]->vertex = vertex;
-            ordering[vertex]->orderNumber = numVerticesRemoved;
+        // sort earlier and later lists
+        if (renumber)
+        {
+            qsort(orientedGraph->later + orientedGraph->laterOffsets[name], numLater(orientedGraph, name), sizeof(int), qsortComparator);
+            qsort(orientedGraph->earlier + orientedGraph->earlierOffsets[name], numEarlier(orientedGraph, name), sizeof(int), qsortComparator);
+        }
+    }
 
-            degree[vertex] = -1;
+    return orientedGraph;
+}
 
-            LinkedList* neighborList = list[vertex];
+/*! \brief compare the peeling keys of two vertices. The key of v is
+           (degree[v], tieKey[v], v), compared in that order.
 
-            Link* neighborLink = neighborList->head->next;
+    \param degree the first part of the key
 
-            while(!isTail(neighborLink))
-            {
-                int neighbor = (int)(size_t) neighborLink->data;
-                //printf("Neighbor: %d\n", neighbor);
+    \param tieKey the second part of the key, or NULL to break ties by vertex only
 
-                if(degree[neighbor]!=-1)
-                {
-                    deleteLink(vertexLocator[neighbor]);
-                    addLast(ordering[vertex]->later, (int)neighbor);
+    \return 1 if the key of u is smaller than the key of v, 0 otherwise.
+*/
 
-                    degree[neighbor]--;
+static inline int peelKeyLess(int u, int v, int* degree, int* tieKey)
+{
+    if (degree[u] != degree[v])
+        return degree[u] < degree[v];
+    if ((tieKey != NULL) && (tieKey[u] != tieKey[v]))
+        return tieKey[u] < tieKey[v];
+    return u < v;
+}
 
-                    if(degree[neighbor] != -1)
-                    {
-                        vertexLocator[neighbor] = 
-                            addFirst(verticesByDegree[degree[neighbor]], 
-                                     (int) neighbor);
-                    }
-                }
-                else
-                {
-                    addLast(ordering[vertex]->earlier, (int) neighbor);
-                }
+/*! \brief move a vertex of a heap of vertices up towards the root while
+           its key is smaller than its parent's, as ordered by peelKeyLess.
 
-                neighborLink = neighborLink->next;
-            }
+    \param heap the vertices, heap[0] has the smallest key
 
-            numVerticesRemoved++;
-            currentDegree = 0;
-        }
-        else
+    \param heapIndex the index of each vertex in heap
+
+    \param degree the first part of the key
+
+    \param tieKey the second part of the key, or NULL
+
+    \param index the index in heap of the vertex to move
+*/
+
+static void siftUpVertex(int* heap, int* heapIndex, int* degree, int* tieKey, int index)
+{
+    int vertex = heap[index];
+
+    while (index > 0)
+    {
+        int parent = heap[(index - 1)/2];
+
+        if (!peelKeyLess(vertex, parent, degree, tieKey))
+            break;
+
+        heap[index] = parent;
+        heapIndex[parent] = index;
+        index = (index - 1)/2;
+    }
+
+    heap[index] = vertex;
+    heapIndex[vertex] = index;
+}
+
+/*! \brief move a vertex of a heap of vertices down while a child has a
+           smaller key. Arguments as for siftUpVertex.
+
+    \param size the number of vertices in heap
+*/
+
+static void siftDownVertex(int* heap, int* heapIndex, int* degree, int* tieKey, int index, int size)
+{
+    while (2*index + 1 < size)
+    {
+        int child = 2*index + 1;
+
+        if (child + 1 < size)
         {
-            currentDegree++;
+            int left = heap[child];
+            int right = heap[child + 1];
+            if (peelKeyLess(right, left, degree, tieKey))
+                child++;
         }
 
+        int vertex = heap[index];
+        int smaller = heap[child];
+
+        if (!peelKeyLess(smaller, vertex, degree, tieKey))
+            break;
+
+        heap[index] = smaller;
+        heapIndex[smaller] = index;
+        heap[child] = vertex;
+        heapIndex[vertex] = child;
+        index = child;
+    }
+}
+
+/*! \brief peel the graph in degeneracy order, always removing the vertex
+           of smallest remaining degree with the smallest tie key, then
+           the smallest id. This takes O(m log n) time with a binary heap.
+
+    \param graph an input graph, in compressed sparse row format
+
+    \param tieKey the tie key of each vertex, or NULL to break ties by id
+
+    \param ordering an array of size graph->n, filled with the vertices in
+                    the order they are removed
+
+    \param position an array of size graph->n, filled with the index of
+                    each vertex in ordering
+
+    \return the degeneracy of the input graph.
+*/
+
+static int computeDegeneracyPeelingTieBreak(CSRGraph* graph, int* tieKey, int* ordering, int* position)
+{
+    int size = graph->n;
+    int degeneracy = 0;
+    int heapSize = size;
+    int i = 0;
+
+    int* degree = (int*) Calloc(max(size, 1), sizeof(int));
+    int* heap = (int*) Calloc(max(size, 1), sizeof(int));
+    int* heapIndex = (int*) Calloc(max(size, 1), sizeof(int));
+
+    for (i = 0; i < size; i++)
+    {
+        degree[i] = (int)(graph->offsets[i+1] - graph->offsets[i]);
+        heap[i] = i;
+        heapIndex[i] = i;
+        position[i] = -1;
     }
 
-    for(i = 0; i<size;i++)
+    for (i = size/2 - 1; i >= 0; i--)
+        siftDownVertex(heap, heapIndex, degree, tieKey, i, size);
+
+    for (i = 0; i < size; i++)
     {
-        destroyLinkedList(verticesByDegree[i]);
+        int vertex = heap[0];
+
+        heapSize--;
+        heap[0] = heap[heapSize];
+        heapIndex[heap[0]] = 0;
+        siftDownVertex(heap, heapIndex, degree, tieKey, 0, heapSize);
+
+        degeneracy = max(degeneracy, degree[vertex]);
+        ordering[i] = vertex;
+        position[vertex] = i;
+
+        long neighborIndex = 0;
+        for (neighborIndex = graph->offsets[vertex]; neighborIndex < graph->offsets[vertex+1]; neighborIndex++)
+        {
+            int neighbor = graph->neighbors[neighborIndex];
+            if (position[neighbor] == -1)
+            {
+                degree[neighbor]--;
+                siftUpVertex(heap, heapIndex, degree, tieKey, heapIndex[neighbor]);
+            }
+        }
     }
 
-    Free(vertexLocator);
-    Free(verticesByDegree);
     Free(degree);
+    Free(heap);
+    Free(heapIndex);
 
-    return ordering;
+    return degeneracy;
 }
 
-/*! \brief
+/*! \brief place the vertices in increasing order of a small integer key,
+           ties by vertex id, with a counting sort.
 
-    \param list an input graph, represented as an array of linked lists of integers
+    \param size the number of vertices
 
-    \param size the number of vertices in the graph
+    \param key the key of each vertex, between 0 and maxKey
 
-    \return an array of NeighborListArrays representing a degeneracy ordering of the vertices.
+    \param maxKey the largest key
 
-    \see NeighborListArray
+    \param ordering filled with the vertices in order
+
+    \param position filled with the index of each vertex in ordering
 */
 
-NeighborListArray** computeDegeneracyOrderArray(LinkedList** list, int size)
+static void orderByKey(int size, int* key, int maxKey, int* ordering, int* position)
 {
+    int* start = (int*) Calloc(maxKey + 2, sizeof(int));
+    int i = 0;
+
+    for (i = 0; i < size; i++)
+        start[key[i] + 1]++;
+    for (i = 0; i <= maxKey; i++)
+        start[i + 1] += start[i];
+
+    for (i = 0; i < size; i++)
+    {
+        position[i] = start[key[i]]++;
+        ordering[position[i]] = i;
+    }
+
+    Free(start);
+}
+
+/*! \brief color the graph greedily, giving each vertex the smallest color
+           that none of its already colored neighbors has. Vertices are
+           colored in decreasing order of degree, so that high degree
+           vertices get small colors.
+
+    \param graph an input graph, in compressed sparse row format
 
-    NeighborList** ordering = (NeighborList**)Calloc(size, sizeof(NeighborList*));
+    \param color an array of size graph->n, filled with the color of each vertex
 
+    \return the number of colors used.
+*/
+
+static int greedyColoring(CSRGraph* graph, int* color)
+{
+    int size = graph->n;
+    int numColors = 0;
+    int maxDegree = 0;
     int i = 0;
 
-    int degeneracy = 0;
-    
-    // array of lists of vertices, indexed by degree
-    LinkedList** verticesByDegree = (LinkedList**) Calloc(size, sizeof(LinkedList*));
+    int* negatedDegree = (int*) Calloc(max(size, 1), sizeof(int));
+    int* byDegree = (int*) Calloc(max(size, 1), sizeof(int));
+    int* position = (int*) Calloc(max(size, 1), sizeof(int));
+
+    for (i = 0; i < size; i++)
+        maxDegree = max(maxDegree, (int)(graph->offsets[i+1] - graph->offsets[i]));
+    for (i = 0; i < size; i++)
+        negatedDegree[i] = maxDegree - (int)(graph->offsets[i+1] - graph->offsets[i]);
+
+    orderByKey(size, negatedDegree, maxDegree, byDegree, position);
 
-    // array of lists of vertices, indexed by degree
-    Link** vertexLocator = (Link**) Calloc(size, sizeof(Link*));
+    // usedBy[c] is the last vertex that found color c on a neighbor
+    int* usedBy = (int*) Calloc(maxDegree + 1, sizeof(int));
 
-    int* degree = (int*) Calloc(size, sizeof(int));
+    for (i = 0; i <= maxDegree; i++)
+        usedBy[i] = -1;
+    for (i = 0; i < size; i++)
+        color[i] = -1;
 
-    for(i = 0; i < size; i++)
+    for (i = 0; i < size; i++)
     {
-        verticesByDegree[i] = createLinkedList();
-        ordering[i] = (NeighborList*)Malloc(sizeof(NeighborList));
-        ordering[i]->earlier = createLinkedList();
-        ordering[i]->later = createLinkedList();
+        int vertex = byDegree[i];
+        long neighborIndex = 0;
+        int c = 0;
+
+        for (neighborIndex = graph->offsets[vertex]; neighborIndex < graph->offsets[vertex+1]; neighborIndex++)
+        {
+            int neighborColor = color[graph->neighbors[neighborIndex]];
+            if (neighborColor != -1)
+                usedBy[neighborColor] = vertex;
+        }
+
+        while (usedBy[c] == vertex)
+            c++;
+
+        color[vertex] = c;
+        numColors = max(numColors, c + 1);
     }
 
-    // fill each cell of degree lookup table
-    // then use that degree to populate the 
-    // lists of vertices indexed by degree
-    // fprintf(stderr, "Ordering is:\n" );
-    for(i=0; i<size; i++)
+    Free(usedBy);
+    Free(negatedDegree);
+    Free(byDegree);
+    Free(position);
+
+    return numColors;
+}
+
+/*! \brief map an ordering name to one of the ORDER_ constants.
+
+    \param name one of degen, degree, degen-degree, degen-id, color, auto
+
+    \return the ordering, or -1 if the name is not known.
+*/
+
+int parseVertexOrder(const char* name)
+{
+    if (strcmp(name, "degen") == 0) return ORDER_DEGENERACY;
+    if (strcmp(name, "degree") == 0) return ORDER_DEGREE;
+    if (strcmp(name, "degen-degree") == 0) return ORDER_DEGENERACY_DEGREE;
+    if (strcmp(name, "degen-id") == 0) return ORDER_DEGENERACY_ID;
+    if (strcmp(name, "color") == 0) return ORDER_COLOR;
+    if (strcmp(name, "auto") == 0) return ORDER_AUTO;
+    return -1;
+}
+
+/*! \brief the name of one of the ORDER_ constants, as parseVertexOrder accepts it.
+*/
+
+const char* vertexOrderName(int order)
+{
+    static const char* names[] = {"degen", "degree", "degen-degree", "degen-id", "color", "auto"};
+    return names[order];
+}
+
+/*! \brief compute one of the vertex orderings. Edges are oriented from
+           earlier to later vertices.
+
+    \param graph an input graph, in compressed sparse row format
+
+    \param order one of the ORDER_ constants other than ORDER_AUTO
+
+    \param ordering an array of size graph->n, filled with the vertices in order
+
+    \param position an array of size graph->n, filled with the index of
+                    each vertex in ordering
+*/
+
+void computeVertexOrder(CSRGraph* graph, int order, int* ordering, int* position)
+{
+    int size = graph->n;
+    int* key = NULL;
+    int i = 0;
+
+    if (order == ORDER_DEGENERACY)
     {
-        degree[i] = length(list[i]);
-        // fprintf(stderr, "i=%d, degree[i]=%d\n",i, degree[i] );
-        vertexLocator[i] = addFirst(verticesByDegree[degree[i]], ((int) i));
+        computeDegeneracyPeeling(graph, ordering, position);
     }
-    // fprintf(stderr, "Ordering is:\n" );
-    int currentDegree = 0;
-
-    int numVerticesRemoved = 0;
+    else if (order == ORDER_DEGENERACY_ID)
+    {
+        computeDegeneracyPeelingTieBreak(graph, NULL, ordering, position);
+    }
+    else if (order == ORDER_DEGENERACY_DEGREE)
+    {
+        key = (int*) Calloc(max(size, 1), sizeof(int));
+        for (i = 0; i < size; i++)
+            key[i] = (int)(graph->offsets[i+1] - graph->offsets[i]);
 
-    while(numVerticesRemoved < size)
+        computeDegeneracyPeelingTieBreak(graph, key, ordering, position);
+    }
+    else if (order == ORDER_DEGREE)
     {
-        if(!isEmpty(verticesByDegree[currentDegree]))
+        int maxDegree = 0;
+        key = (int*) Calloc(max(size, 1), sizeof(int));
+        for (i = 0; i < size; i++)
         {
-            degeneracy = max(degeneracy,currentDegree);
-            
-            int vertex = (int)(size_t) getFirst(verticesByDegree[currentDegree]);
+            key[i] = (int)(graph->offsets[i+1] - graph->offsets[i]);
+            maxDegree = max(maxDegree, key[i]);
+        }
+
+        orderByKey(size, key, maxDegree, ordering, position);
+    }
+    else
+    {
+        // largest colors first, so that the later neighbors of a vertex
+        // all have smaller colors than it
+        key = (int*) Calloc(max(size, 1), sizeof(int));
+        int numColors = greedyColoring(graph, key);
+        for (i = 0; i < size; i++)
+            key[i] = numColors - 1 - key[i];
+
+        orderByKey(size, key, max(numColors - 1, 0), ordering, position);
+    }
 
-            deleteLink(vertexLocator[vertex]);
+    Free(key);
+}
 
-            ordering[vertex]->vertex = vertex;
-            ordering[vertex]->orderNumber = numVerticesRemoved;
-            // fprintf(stderr, "vertex = %d, degree[vertex]=%d\n", vertex, degree[vertex]);
-            degree[vertex] = -1;
+/*! \brief the state shared by the threads of computeApproxDegeneracyPeeling.
+*/
 
-            LinkedList* neighborList = list[vertex];
+struct ApproxPeelState
+{
+    CSRGraph* graph;
+    double epsilon; //!< vertices with degree up to (1+epsilon) times the minimum are removed together
+    int numThreads;
+    int* degree; //!< the number of neighbors not yet removed
+    int* ordering; //!< the vertices removed so far, in order
+    int* position; //!< the index of each vertex in ordering, or -1 while it is in the graph
+    int* alive; //!< the vertices still in the graph
+    int* kept; //!< scratch: the vertices of alive that stay this round
+    int* removed; //!< scratch: the vertices of alive that go this round
+    int* localMin; //!< per thread, the minimum degree in its part of alive
+    int* numLocalRemoved; //!< per thread, the number of its vertices removed this round
+    int* numRounds; //!< the number of rounds, written by thread 0
+    pthread_barrier_t barrier;
+};
+
+typedef struct ApproxPeelState ApproxPeelState;
+
+/*! \brief one thread of computeApproxDegeneracyPeeling. The threads take
+           equal parts of the vertices still in the graph and meet at a
+           barrier between the phases of every round.
+*/
 
-            Link* neighborLink = neighborList->head->next;
+struct ApproxPeelThread
+{
+    ApproxPeelState* state;
+    int thread; //!< the index of this thread
+};
 
-            while(!isTail(neighborLink))
-            {
-                int neighbor = (int)(size_t) (neighborLink->data);
-                // fprintf(stderr, "neighbor = %d, degree[neighbor] = %d, ordering[neighbor]->orderNumber=%d\n",neighbor, degree[neighbor], ordering[neighbor]->orderNumber);
-                if(degree[neighbor]!=-1)
-                {
-                    deleteLink(vertexLocator[neighbor]);
-                    addLast(ordering[vertex]->later, (int)neighbor);
+typedef struct ApproxPeelThread ApproxPeelThread;
 
-                    // fprintf(stderr, "In. neighbor = %d, degree[neighbor] = %d, ordering[neighbor]->orderNumber=%d\n",neighbor, degree[neighbor], ordering[neighbor]->orderNumber);
-                    degree[neighbor]--;
+/*! \brief peel rounds with the other threads until the graph is empty;
+           run as a thread.
 
-                    if(degree[neighbor] != -1)
-                    {
-                        vertexLocator[neighbor] = 
-                            addFirst(verticesByDegree[degree[neighbor]], 
-                                     (int) neighbor);
-                    }
-                }
-                else
-                {
-                    addLast(ordering[vertex]->earlier, (int) neighbor);
-                }
+    \param arg the ApproxPeelThread of this thread.
+*/
 
-                neighborLink = neighborLink->next;
-            }
+static void* approxPeelThread(void* arg)
+{
+    ApproxPeelState* state = ((ApproxPeelThread*)arg)->state;
+    int thread = ((ApproxPeelThread*)arg)->thread;
+    int numThreads = state->numThreads;
+    CSRGraph* graph = state->graph;
+    int numAlive = graph->n;
+    int numRemoved = 0;
+    int rounds = 0;
+    int i = 0;
+    int t = 0;
 
-            numVerticesRemoved++;
-            currentDegree = 0;
-        }
-        else
+    while (numAlive > 0)
+    {
+        int begin = (int)((long)numAlive*thread/numThreads);
+        int end = (int)((long)numAlive*(thread+1)/numThreads);
+
+        int localMin = graph->n;
+        for (i = begin; i < end; i++)
+            localMin = min(localMin, state->degree[state->alive[i]]);
+        state->localMin[thread] = localMin;
+
+        pthread_barrier_wait(&state->barrier);
+
+        // every thread works out the same threshold
+        int minDegree = graph->n;
+        for (t = 0; t < numThreads; t++)
+            minDegree = min(minDegree, state->localMin[t]);
+        double bound = (1.0 + state->epsilon)*minDegree;
+        int threshold = (bound >= graph->n) ? graph->n : (int)bound;
+
+        int numKept = 0;
+        int numLocalRemoved = 0;
+        for (i = begin; i < end; i++)
         {
-            currentDegree++;
+            int vertex = state->alive[i];
+            if (state->degree[vertex] <= threshold)
+                state->removed[begin + numLocalRemoved++] = vertex;
+            else
+                state->kept[begin + numKept++] = vertex;
         }
+        state->numLocalRemoved[thread] = numLocalRemoved;
 
-    }
-    
-    NeighborListArray** orderingArray = (NeighborListArray**)Calloc(size, sizeof(NeighborListArray*));
+        pthread_barrier_wait(&state->barrier);
 
-    for(i = 0; i<size;i++)
-    {
-        orderingArray[i] = (NeighborListArray*)Malloc(sizeof(NeighborListArray));
-        orderingArray[i]->vertex = ordering[i]->vertex;
-        orderingArray[i]->orderNumber = ordering[i]->orderNumber;
-        // if (orderingArray[i]->vertex == 175421) fprintf(stderr, "175421, orderNumber = %d\n", ordering[i]->orderNumber );
-        // if (orderingArray[i]->vertex == 573) fprintf(stderr, "573, orderNumber = %d\n", ordering[i]->orderNumber );
-        orderingArray[i]->laterDegree = length(ordering[i]->later);
-        orderingArray[i]->later = (int *)Calloc(orderingArray[i]->laterDegree, sizeof(int));
+        // place this round's vertices after the earlier rounds, in
+        // thread order, and compact the vertices that stay
+        int removedBefore = 0;
+        int totalRemoved = 0;
+        for (t = 0; t < numThreads; t++)
+        {
+            if (t == thread) removedBefore = totalRemoved;
+            totalRemoved += state->numLocalRemoved[t];
+        }
+        int keptBefore = begin - removedBefore;
 
-        int j=0;
-        Link* curr = ordering[i]->later->head->next;
-        while(!isTail(curr))
+        for (i = 0; i < numLocalRemoved; i++)
         {
-            orderingArray[i]->later[j++] = (int)(size_t)(curr->data);
-            curr = curr->next;
+            int vertex = state->removed[begin + i];
+            state->ordering[numRemoved + removedBefore + i] = vertex;
+            state->position[vertex] = numRemoved + removedBefore + i;
         }
+        for (i = 0; i < numKept; i++)
+            state->alive[keptBefore + i] = state->kept[begin + i];
 
-        orderingArray[i]->earlierDegree = length(ordering[i]->earlier);
-        orderingArray[i]->earlier = (int *)Calloc(orderingArray[i]->earlierDegree, sizeof(int));
+        pthread_barrier_wait(&state->barrier);
 
-        j=0;
-        curr = ordering[i]->earlier->head->next;
-        while(!isTail(curr))
+        for (i = 0; i < numLocalRemoved; i++)
         {
-            orderingArray[i]->earlier[j++] = (int)(size_t)(curr->data);
-            curr = curr->next;
+            int vertex = state->removed[begin + i];
+            long neighborIndex = 0;
+
+            for (neighborIndex = graph->offsets[vertex]; neighborIndex < graph->offsets[vertex+1]; neighborIndex++)
+            {
+                int neighbor = graph->neighbors[neighborIndex];
+                if (state->position[neighbor] == -1)
+                    __atomic_fetch_sub(&state->degree[neighbor], 1, __ATOMIC_RELAXED);
+            }
         }
+
+        numRemoved += totalRemoved;
+        numAlive -= totalRemoved;
+        rounds++;
+
+        pthread_barrier_wait(&state->barrier);
+    }
+
+    if (thread == 0) *state->numRounds = rounds;
+
+    return NULL;
+}
+
+/*! \brief peel the graph on all cores in rounds: each round removes every
+           vertex whose remaining degree is at most (1+epsilon) times the
+           smallest remaining degree. Each vertex has at most that many
+           neighbors when it is removed, and the smallest remaining degree
+           never exceeds the degeneracy, so every vertex has at most
+           (1+epsilon) times the degeneracy later neighbors.
+
+    \param graph an input graph, in compressed sparse row format
+
+    \param epsilon how far the ordering may be from a degeneracy ordering
+
+    \param ordering an array of size graph->n, filled with the vertices in
+                    the order they are removed
+
+    \param position an array of size graph->n, filled with the index of
+                    each vertex in ordering
+
+    \return the number of rounds.
+*/
+
+int computeApproxDegeneracyPeeling(CSRGraph* graph, double epsilon, int* ordering, int* position)
+{
+    int size = graph->n;
+    int numThreads = numLoaderThreads(graph->m*sizeof(int));
+    int numRounds = 0;
+    int i = 0;
+
+    ApproxPeelState state;
+    state.graph = graph;
+    state.epsilon = epsilon;
+    state.numThreads = numThreads;
+    state.degree = (int*) Calloc(max(size, 1), sizeof(int));
+    state.ordering = ordering;
+    state.position = position;
+    state.alive = (int*) Calloc(max(size, 1), sizeof(int));
+    state.kept = (int*) Calloc(max(size, 1), sizeof(int));
+    state.removed = (int*) Calloc(max(size, 1), sizeof(int));
+    state.localMin = (int*) Calloc(numThreads, sizeof(int));
+    state.numLocalRemoved = (int*) Calloc(numThreads, sizeof(int));
+    state.numRounds = &numRounds;
+    pthread_barrier_init(&state.barrier, NULL, numThreads);
+
+    for (i = 0; i < size; i++)
+    {
+        state.degree[i] = (int)(graph->offsets[i+1] - graph->offsets[i]);
+        state.alive[i] = i;
+        position[i] = -1;
     }
 
-    // fprintf(stderr, "Ordering is:\n" );
-    for(i = 0; i<size;i++)
+    ApproxPeelThread* threads = (ApproxPeelThread*) Calloc(numThreads, sizeof(ApproxPeelThread));
+    for (i = 0; i < numThreads; i++)
     {
-        // fprintf(stderr, "vertex = %d, orderNumber = %d, laterdeg = %d, earlierdeg = %d\n", orderingArray[i]->vertex, orderingArray[i]->orderNumber, orderingArray[i]->laterDegree, orderingArray[i]->earlierDegree );
-        Free(ordering[i]);
-        destroyLinkedList(verticesByDegree[i]);
+        threads[i].state = &state;
+        threads[i].thread = i;
     }
 
-    Free(ordering);
+    runThreads(approxPeelThread, threads, sizeof(ApproxPeelThread), numThreads);
 
-    Free(vertexLocator);
-    Free(verticesByDegree);
-    Free(degree);
+    pthread_barrier_destroy(&state.barrier);
+    Free(threads);
+    Free(state.degree);
+    Free(state.alive);
+    Free(state.kept);
+    Free(state.removed);
+    Free(state.localMin);
+    Free(state.numLocalRemoved);
 
-    return orderingArray;
+    return numRounds;
 }
 
-/*! \brief
+/*! \brief the state shared by the threads of computeCoreNumbers.
+*/
+
+struct CorePeelState
+{
+    CSRGraph* graph;
+    int numThreads;
+    int* degree; //!< the number of neighbors not yet removed, never below the current level
+    int* core; //!< the core number of each vertex, filled as vertices are removed
+    int* numLocalRemoved; //!< per thread, the number of vertices it removed this level
+    int* degeneracy; //!< the last level with a vertex, written by thread 0
+    pthread_barrier_t barrier;
+};
+
+typedef struct CorePeelState CorePeelState;
+
+/*! \brief one thread of computeCoreNumbers. Each thread scans a fixed
+           range of the vertices for the ones at the current level, then
+           removes them and whatever drops to the level after them.
+*/
 
-    \param list an input graph, represented as an array of linked lists of integers
+struct CorePeelThread
+{
+    CorePeelState* state;
+    int thread; //!< the index of this thread
+};
 
-    \param size the number of vertices in the graph
+typedef struct CorePeelThread CorePeelThread;
 
-    \return an array of NeighborListArrays representing a degeneracy ordering of the vertices. The vertics are renamed according to their order in the degeneracy ordering.
-    \see NeighborListArray 
+/*! \brief remove the vertices level by level with the other threads until
+           the graph is empty; run as a thread.
 
+    \param arg the CorePeelThread of this thread.
 */
 
-NeighborListArray **computeDegeneracyOrderArrayVerticesSorted(LinkedList **list, int size)
+static void* corePeelThread(void* arg)
 {
+    CorePeelState* state = ((CorePeelThread*)arg)->state;
+    int thread = ((CorePeelThread*)arg)->thread;
+    int numThreads = state->numThreads;
+    CSRGraph* graph = state->graph;
+    int size = graph->n;
+    int begin = (int)((long)size*thread/numThreads);
+    int end = (int)((long)size*(thread+1)/numThreads);
+    int capacity = max(end - begin, 16);
+    int* frontier = (int*) Calloc(capacity, sizeof(int));
+    int numRemoved = 0;
+    int level = 0;
+    int i = 0;
+    int t = 0;
 
-    NeighborList **ordering = (NeighborList **)Calloc(size, sizeof(NeighborList *));
-    
-    // mapping from original vertex number to new vertex number in the ordering
-    int *vertexMapping = (int *)Calloc(size, sizeof(int));
+    while (numRemoved < size)
+    {
+        int numFrontier = 0;
 
-    int i = 0;
+        // every vertex at the level was pushed down to it in an earlier
+        // level, or started there; none of them is in a frontier yet
+        for (i = begin; i < end; i++)
+        {
+            if (state->degree[i] == level)
+                frontier[numFrontier++] = i;
+        }
 
-    int degeneracy = 0;
+        pthread_barrier_wait(&state->barrier);
+
+        for (i = 0; i < numFrontier; i++)
+        {
+            int vertex = frontier[i];
+            long neighborIndex = 0;
+
+            state->core[vertex] = level;
+
+            for (neighborIndex = graph->offsets[vertex]; neighborIndex < graph->offsets[vertex+1]; neighborIndex++)
+            {
+                int neighbor = graph->neighbors[neighborIndex];
+
+                if (__atomic_load_n(&state->degree[neighbor], __ATOMIC_RELAXED) <= level)
+                    continue;
+
+                // exactly one thread sees the neighbor reach the level and
+                // takes it; a thread that went below the level undoes it
+                int before = __atomic_fetch_sub(&state->degree[neighbor], 1, __ATOMIC_RELAXED);
+                if (before == level + 1)
+                {
+                    if (numFrontier == capacity)
+                    {
+                        capacity *= 2;
+                        frontier = (int*) Realloc(frontier, capacity*sizeof(int));
+                    }
+                    frontier[numFrontier++] = neighbor;
+                }
+                else if (before <= level)
+                    __atomic_fetch_add(&state->degree[neighbor], 1, __ATOMIC_RELAXED);
+            }
+        }
+        state->numLocalRemoved[thread] = numFrontier;
+
+        pthread_barrier_wait(&state->barrier);
 
-    // array of lists of vertices, indexed by degree
-    LinkedList **verticesByDegree = (LinkedList **)Calloc(size, sizeof(LinkedList *));
+        for (t = 0; t < numThreads; t++)
+            numRemoved += state->numLocalRemoved[t];
+        level++;
+    }
+
+    if (thread == 0) *state->degeneracy = max(level - 1, 0);
+
+    Free(frontier);
+
+    return NULL;
+}
+
+/*! \brief compute the core number of every vertex on all cores: the
+           largest k such that the vertex is in a subgraph whose vertices
+           all have degree at least k. The threads peel one level at a
+           time; at level k they remove every vertex whose remaining degree
+           is k, including the ones that fall to k while they do.
 
-    // array of lists of vertices, indexed by degree
-    Link **vertexLocator = (Link **)Calloc(size, sizeof(Link *));
+    \param graph an input graph, in compressed sparse row format
+
+    \param core an array of size graph->n, filled with the core number of
+                each vertex
+
+    \return the degeneracy of the input graph, the largest core number.
+*/
+
+int computeCoreNumbers(CSRGraph* graph, int* core)
+{
+    int size = graph->n;
+    int numThreads = numLoaderThreads(graph->m*sizeof(int));
+    int degeneracy = 0;
+    int i = 0;
 
-    int *degree = (int *)Calloc(size, sizeof(int));
+    CorePeelState state;
+    state.graph = graph;
+    state.numThreads = numThreads;
+    state.degree = (int*) Calloc(max(size, 1), sizeof(int));
+    state.core = core;
+    state.numLocalRemoved = (int*) Calloc(numThreads, sizeof(int));
+    state.degeneracy = &degeneracy;
+    pthread_barrier_init(&state.barrier, NULL, numThreads);
 
     for (i = 0; i < size; i++)
+        state.degree[i] = (int)(graph->offsets[i+1] - graph->offsets[i]);
+
+    CorePeelThread* threads = (CorePeelThread*) Calloc(numThreads, sizeof(CorePeelThread));
+    for (i = 0; i < numThreads; i++)
     {
-        verticesByDegree[i] = createLinkedList();
-        ordering[i] = (NeighborList *)Malloc(sizeof(NeighborList));
-        ordering[i]->earlier = createLinkedList();
-        ordering[i]->later = createLinkedList();
+        threads[i].state = &state;
+        threads[i].thread = i;
     }
 
-    // fill each cell of degree lookup table
-    // then use that degree to populate the
-    // lists of vertices indexed by degree
-    // fprintf(stderr, "Ordering is:\n" );
+    runThreads(corePeelThread, threads, sizeof(CorePeelThread), numThreads);
+
+    pthread_barrier_destroy(&state.barrier);
+    Free(threads);
+    Free(state.degree);
+    Free(state.numLocalRemoved);
+
+    return degeneracy;
+}
+
+/*! \brief keep only the vertices of the minCore-core: the subgraph induced
+           by the vertices whose core number is at least minCore. No clique
+           of more than minCore vertices has a vertex outside it. Vertices
+           keep their relative order, so sorted adjacency lists stay sorted.
+
+    \param graph an input graph, in compressed sparse row format
+
+    \param minCore the smallest core number to keep
+
+    \param name set to an array, indexed by vertex of the returned graph,
+                holding the vertex of graph it came from
+
+    \return the induced subgraph, which the caller destroys.
+*/
+
+CSRGraph* pruneToCore(CSRGraph* graph, int minCore, int** name)
+{
+    int size = graph->n;
+    int* core = (int*) Calloc(max(size, 1), sizeof(int));
+    int i = 0;
+
+    computeCoreNumbers(graph, core);
+
+    // core is reused as the new name of every kept vertex, -1 otherwise
+    int numKept = 0;
+    for (i = 0; i < size; i++)
+        core[i] = (core[i] >= minCore) ? numKept++ : -1;
+
+    CSRGraph* pruned = (CSRGraph*) Calloc(1, sizeof(CSRGraph));
+    pruned->n = numKept;
+    pruned->offsets = (long*) Calloc(numKept + 1, sizeof(long));
+    *name = (int*) Calloc(max(numKept, 1), sizeof(int));
+
     for (i = 0; i < size; i++)
     {
-        degree[i] = length(list[i]);
-        // fprintf(stderr, "i=%d, degree[i]=%d\n",i, degree[i] );
-        vertexLocator[i] = addFirst(verticesByDegree[degree[i]], ((int)i));
+        if (core[i] < 0) continue;
+
+        long degree = 0;
+        for (long neighborIndex = graph->offsets[i]; neighborIndex < graph->offsets[i+1]; neighborIndex++)
+            degree += (core[graph->neighbors[neighborIndex]] >= 0);
+
+        (*name)[core[i]] = i;
+        pruned->offsets[core[i]+1] = pruned->offsets[core[i]] + degree;
     }
-    // fprintf(stderr, "Ordering is:\n" );
-    int currentDegree = 0;
 
-    int numVerticesRemoved = 0;
+    pruned->m = pruned->offsets[numKept];
+    pruned->neighbors = (int*) Malloc(max(pruned->m, 1)*sizeof(int));
 
-    while (numVerticesRemoved < size)
+    for (i = 0; i < size; i++)
     {
-        if (!isEmpty(verticesByDegree[currentDegree]))
+        if (core[i] < 0) continue;
+
+        long next = pruned->offsets[core[i]];
+        for (long neighborIndex = graph->offsets[i]; neighborIndex < graph->offsets[i+1]; neighborIndex++)
         {
-            degeneracy = max(degeneracy, currentDegree);
+            int neighbor = graph->neighbors[neighborIndex];
+            if (core[neighbor] >= 0)
+                pruned->neighbors[next++] = core[neighbor];
+        }
+    }
 
-            int vertex = (int)(size_t)getFirst(verticesByDegree[currentDegree]);
+    Free(core);
 
-            deleteLink(vertexLocator[vertex]);
+    return pruned;
+}
 
-            ordering[vertex]->vertex = vertex;
-            ordering[vertex]->orderNumber = numVerticesRemoved;
-        
-            vertexMapping[vertex] = numVerticesRemoved; // map vertex number to new vertex number in ordering
+/*! \brief write a vertex ordering to a file, so that later runs on the
+           same graph can load it with readOrderFile instead of computing it.
+           The file is written under a temporary name and renamed into place.
 
-            // fprintf(stderr, "vertex = %d, degree[vertex]=%d\n", vertex, degree[vertex]);
-            degree[vertex] = -1;
+    \param path the path of the ordering file
 
-            LinkedList *neighborList = list[vertex];
+    \param graph the graph the ordering was computed for
 
-            Link *neighborLink = neighborList->head->next;
+    \param position the index of each vertex in the ordering
 
-            while (!isTail(neighborLink))
-            {
-                int neighbor = (int)(size_t)(neighborLink->data);
-                // fprintf(stderr, "neighbor = %d, degree[neighbor] = %d, ordering[neighbor]->orderNumber=%d\n",neighbor, degree[neighbor], ordering[neighbor]->orderNumber);
-                if (degree[neighbor] != -1)
-                {
-                    deleteLink(vertexLocator[neighbor]);
-                    addLast(ordering[vertex]->later, (int)neighbor);
+    \param order the ORDER_ constant the ordering was computed with
 
-                    // fprintf(stderr, "In. neighbor = %d, degree[neighbor] = %d, ordering[neighbor]->orderNumber=%d\n",neighbor, degree[neighbor], ordering[neighbor]->orderNumber);
-                    degree[neighbor]--;
+    \param epsilon above 0 if the ordering is approximate
 
-                    if (degree[neighbor] != -1)
-                    {
-                        vertexLocator[neighbor] =
-                            addFirst(verticesByDegree[degree[neighbor]],
-                                     (int)neighbor);
-                    }
-                }
-                else
-                {
-                    addLast(ordering[vertex]->earlier, (int)neighbor);
-                }
+    \param degeneracy the exact degeneracy of the graph
 
-                neighborLink = neighborLink->next;
-            }
+    \return 1 on success, 0 if the file could not be written.
+*/
 
-            numVerticesRemoved++;
-            currentDegree = 0;
-        }
-        else
-        {
-            currentDegree++;
-        }
+int writeOrderFile(const char* path, CSRGraph* graph, int* position, int order, double epsilon, int degeneracy)
+{
+    OrderFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, ORDER_FILE_MAGIC, 8);
+    header.version = ORDER_FILE_VERSION;
+    header.headerSize = sizeof(OrderFileHeader);
+    header.n = graph->n;
+    header.m = graph->m;
+    header.graphChecksum = csrChecksum(graph);
+    header.order = order;
+    header.degeneracy = degeneracy;
+    header.epsilon = epsilon;
+
+    char* tmpPath = (char *)Calloc(strlen(path) + 5, sizeof(char));
+    strcpy(tmpPath, path);
+    strcat(tmpPath, ".tmp");
+
+    FILE* fp = fopen(tmpPath, "wb");
+    if (!fp)
+    {
+        Free(tmpPath);
+        return 0;
     }
 
-    NeighborListArray **orderingArray = (NeighborListArray **)Calloc(size, sizeof(NeighborListArray *));
+    int ok = (fwrite(&header, sizeof(header), 1, fp) == 1)
+          && (fwrite(position, sizeof(int), graph->n, fp) == (size_t)graph->n);
+
+    ok = (fclose(fp) == 0) && ok;
+
+    if (ok) ok = (rename(tmpPath, path) == 0);
+    if (!ok) remove(tmpPath);
+
+    Free(tmpPath);
+    return ok;
+}
+
+/*! \brief load a vertex ordering written by writeOrderFile.
+
+    \param path the path of the ordering file
+
+    \param graph the graph to order; the file must have been written for
+                 exactly this graph
+
+    \param ordering an array of size graph->n, filled with the vertices in order
+
+    \param position an array of size graph->n, filled with the index of
+                    each vertex in ordering
+
+    \param order set to the ORDER_ constant the ordering was computed with
+
+    \param epsilon set to the epsilon of an approximate ordering, or 0
+
+    \param degeneracy set to the exact degeneracy of the graph
+
+    \return 1 on success, 0 if the file cannot be read, is from another
+            version, was written for a different graph, or is not a
+            permutation of the vertices.
+*/
+
+int readOrderFile(const char* path, CSRGraph* graph, int* ordering, int* position,
+                  int* order, double* epsilon, int* degeneracy)
+{
+    FILE* fp = fopen(path, "rb");
+    if (!fp) return 0;
+
+    OrderFileHeader header;
+    int size = graph->n;
+    int i = 0;
+
+    int ok = (fread(&header, sizeof(header), 1, fp) == 1)
+          && (memcmp(header.magic, ORDER_FILE_MAGIC, 8) == 0)
+          && (header.version == ORDER_FILE_VERSION)
+          && (header.headerSize == sizeof(OrderFileHeader))
+          && (header.n == size)
+          && (header.m == graph->m)
+          && (header.order >= 0) && (header.order < NUM_VERTEX_ORDERS)
+          && (fread(position, sizeof(int), size, fp) == (size_t)size)
+          && (header.graphChecksum == csrChecksum(graph));
 
-    int v;
-    for (v = 0; v < size; v++)
+    fclose(fp);
+
+    if (!ok) return 0;
+
+    for (i = 0; i < size; i++)
+        ordering[i] = -1;
+
+    for (i = 0; i < size; i++)
     {
-        i = vertexMapping[v];
-        orderingArray[i] = (NeighborListArray *)Malloc(sizeof(NeighborListArray));
-        //orderingArray[i]->vertex = ordering[i]->vertex;
-        // orderingArray[i]->vertex = ordering[i]->orderNumber; // rename vertex to its order in the ordering
-        // orderingArray[i]->orderNumber = ordering[i]->orderNumber;
-        orderingArray[i]->vertex = i;// rename vertex to its order in the ordering
-        orderingArray[i]->orderNumber = i;
-        // if (orderingArray[i]->vertex == 175421) fprintf(stderr, "175421, orderNumber = %d\n", ordering[i]->orderNumber );
-        // if (orderingArray[i]->vertex == 573) fprintf(stderr, "573, orderNumber = %d\n", ordering[i]->orderNumber );
-        orderingArray[i]->laterDegree = length(ordering[v]->later);
-        orderingArray[i]->later = (int *)Calloc(orderingArray[i]->laterDegree, sizeof(int));
+        if ((position[i] < 0) || (position[i] >= size) || (ordering[position[i]] != -1))
+            return 0;
+        ordering[position[i]] = i;
+    }
+
+    *order = header.order;
+    *epsilon = header.epsilon;
+    *degeneracy = header.degeneracy;
+
+    return 1;
+}
+
+/*! \brief free an OrientedGraph.
+
+    \param orientedGraph an ordering, as returned by computeOrientedGraph
+*/
+
+void destroyOrientedGraph(OrientedGraph* orientedGraph)
+{
+    Free(orientedGraph->orderNumber);
+    Free(orientedGraph->laterOffsets);
+    Free(orientedGraph->later);
+    Free(orientedGraph->earlierOffsets);
+    Free(orientedGraph->earlier);
+    Free(orientedGraph->packedOffsets);
+    Free(orientedGraph->laterPacked);
+    Free(orientedGraph->originalName);
+    Free(orientedGraph->weight);
+    Free(orientedGraph);
+}
+
+/*! \brief give the vertices of an oriented graph weights, following
+           them through a renaming.
+
+    \param orientedGraph an oriented graph
+
+    \param weight the weight of each vertex of the graph it was built from
+*/
+
+void setOrientedGraphWeights(OrientedGraph* orientedGraph, int* weight)
+{
+    int i = 0;
+
+    Free(orientedGraph->weight);
+    orientedGraph->weight = (int*)Malloc(max(orientedGraph->n, 1)*sizeof(int));
+
+    for (i = 0; i < orientedGraph->n; i++)
+        orientedGraph->weight[i] = weight[originalVertex(orientedGraph, i)];
+}
+
+/*! \brief replace the later lists by packed copies: the neighbors of
+           each vertex are sorted and each is stored as its gap from the
+           previous one, 7 bits per byte. The earlier lists, which the
+           recursion never reads, are freed; their offsets are kept.
+
+    \param orientedGraph an ordering, as returned by computeOrientedGraph
+
+    \return the number of bytes of the packed lists
+*/
+
+long compressOrientedGraph(OrientedGraph* orientedGraph)
+{
+    int size = orientedGraph->n;
+    int i = 0;
+
+    orientedGraph->packedOffsets = (long *)Calloc(size + 1, sizeof(long));
 
+    for (i = 0; i < size; i++)
+    {
+        int* later = orientedGraph->later + orientedGraph->laterOffsets[i];
+        int degree = numLater(orientedGraph, i);
+        int previous = -1;
+        long numBytes = 0;
         int j = 0;
-        Link *curr = ordering[v]->later->head->next;
-        while (!isTail(curr))
-        {
-            orderingArray[i]->later[j++] = vertexMapping[(int)(size_t)(curr->data)]; // rename neighbor to its order in the ordering
-            curr = curr->next;
-        }
 
-        orderingArray[i]->earlierDegree = length(ordering[v]->earlier);
-        orderingArray[i]->earlier = (int *)Calloc(orderingArray[i]->earlierDegree, sizeof(int));
+        qsort(later, degree, sizeof(int), qsortComparator);
 
-        j = 0;
-        curr = ordering[v]->earlier->head->next;
-        while (!isTail(curr))
+        for (j = 0; j < degree; j++)
         {
-            orderingArray[i]->earlier[j++] = vertexMapping[(int)(size_t)(curr->data)]; // rename neighbor to its order in the ordering
-            curr = curr->next;
+            unsigned int gap = (unsigned int)(later[j] - previous - 1);
+            do
+            {
+                numBytes++;
+                gap >>= 7;
+            } while (gap != 0);
+            previous = later[j];
         }
 
-        // sort earlier and later arrays
-        qsort(orderingArray[i]->earlier, orderingArray[i]->earlierDegree, sizeof(int), qsortComparator);
-        qsort(orderingArray[i]->later, orderingArray[i]->laterDegree, sizeof(int), qsortComparator);
+        orientedGraph->packedOffsets[i+1] = orientedGraph->packedOffsets[i] + numBytes;
     }
 
-    // fprintf(stderr, "Ordering is:\n" );
+    long totalBytes = orientedGraph->packedOffsets[size];
+    unsigned char* packed = (unsigned char *)Malloc(max(totalBytes, 1));
+    unsigned char* p = packed;
+
     for (i = 0; i < size; i++)
     {
-        // fprintf(stderr, "vertex = %d, orderNumber = %d, laterdeg = %d, earlierdeg = %d\n", orderingArray[i]->vertex, orderingArray[i]->orderNumber, orderingArray[i]->laterDegree, orderingArray[i]->earlierDegree );
-        // if(orderingArray[i]->laterDegree>1)
-        //     fprintf(stderr, "First second later neighbor = %d %d\n", orderingArray[i]->later[0], orderingArray[i]->later[1]);
-        // if (orderingArray[i]->earlierDegree > 1)
-        //     fprintf(stderr, "First second earlier neighbor = %d %d\n", orderingArray[i]->earlier[0], orderingArray[i]->earlier[1]);
+        int* later = orientedGraph->later + orientedGraph->laterOffsets[i];
+        int degree = numLater(orientedGraph, i);
+        int previous = -1;
+        int j = 0;
 
-        Free(ordering[i]);
-        destroyLinkedList(verticesByDegree[i]);
+        for (j = 0; j < degree; j++)
+        {
+            unsigned int gap = (unsigned int)(later[j] - previous - 1);
+            while (gap >= 0x80)
+            {
+                *p++ = (unsigned char)(gap | 0x80);
+                gap >>= 7;
+            }
+            *p++ = (unsigned char)gap;
+            previous = later[j];
+        }
     }
 
-    Free(ordering);
-
-    Free(vertexLocator);
-    Free(verticesByDegree);
-    Free(degree);
-
-    Free(vertexMapping);
+    Free(orientedGraph->later);
+    Free(orientedGraph->earlier);
+    orientedGraph->later = NULL;
+    orientedGraph->earlier = NULL;
+    orientedGraph->laterPacked = packed;
 
-    return orderingArray;
+    return totalBytes;
 }
@@ -32,58 +32,168 @@
 #include<assert.h>
 #include<stdio.h>
 #include<stdlib.h>
+#include<stdint.h>
 
 #include"misc.h"
 #include"LinkedList.h"
 #include"MemoryManager.h"
+#include"graph_io.h"
+
+#define ORDER_DEGENERACY 0 //!< degeneracy ordering, by the bin sort of computeDegeneracyPeeling
+#define ORDER_DEGREE 1 //!< increasing degree, ties by vertex id
+#define ORDER_DEGENERACY_DEGREE 2 //!< degeneracy ordering, ties by smaller degree, then vertex id
+#define ORDER_DEGENERACY_ID 3 //!< degeneracy ordering, ties by vertex id
+#define ORDER_COLOR 4 //!< decreasing greedy color, so later neighbors have smaller colors
+#define ORDER_AUTO 5 //!< whichever of the above has the cheapest sampled recursion
+#define NUM_VERTEX_ORDERS 5 //!< the number of orderings auto chooses from
+
+#define ORDER_FILE_MAGIC "NCCLQORD"
+#define ORDER_FILE_VERSION 1
 
 /*! 
 */
 
 
-/*! \struct NeighborList
+/*! \struct OrientedGraph
+
+    \brief For a given ordering, the neighbors that come after (later) and
+           before (earlier) every vertex, in compressed sparse row format.
+           The later neighbors of v are later[laterOffsets[v]] to
+           later[laterOffsets[v+1]-1], and likewise for earlier.
 
-    \brief For a given ordering, this stores later neighbors and earlier neighbors
-           for a given vertex in linked lists.
+    All vertices share one offsets array and one block per direction, so
+    reaching the neighbors of a vertex takes no pointer chasing, and the
+    whole structure is freed with a handful of calls.
 */
 
-struct NeighborList
+struct OrientedGraph
 {
-    int vertex; //!< the vertex that owns this neighbor list
-    LinkedList* earlier; //!< a linked list of neighbors that come before this vertex in the ordering
-    LinkedList* later; //!< a linked list of neighbors that come after this vertex in the ordering
-    int orderNumber; //!< the position of this verex in the ordering
+    int n; //!< the number of vertices
+    long m; //!< the number of edges, the size of later and of earlier
+    int* orderNumber; //!< the position of each vertex in the ordering
+    long* laterOffsets; //!< n+1 offsets into later
+    int* later; //!< the neighbors of every vertex that come after it, or NULL once packed
+    long* earlierOffsets; //!< n+1 offsets into earlier
+    int* earlier; //!< the neighbors of every vertex that come before it, or NULL once packed
+    long* packedOffsets; //!< n+1 offsets into laterPacked, or NULL
+    unsigned char* laterPacked; //!< each later list sorted and delta + varint encoded by compressOrientedGraph, or NULL
+    int* originalName; //!< the input name of every vertex if vertices were renamed to their positions, or NULL
+    int* weight; //!< the number of input vertices each vertex stands for, or NULL if every vertex is one (see twins.h)
 };
 
-typedef struct NeighborList NeighborList;
+typedef struct OrientedGraph OrientedGraph;
 
-/*! \struct NeighborListArray
+/*! \struct OrderFileHeader
 
-    \brief For a given ordering, this stores later neighbors and earlier neighbors
-           for a given vertex in arrays.
-
-    This version of the NeighborList structure is more cache efficient.
+    \brief The 64 byte header of an ordering file written by writeOrderFile.
+           It is followed by n 32-bit positions: the index of every vertex
+           in the ordering, which is also its name when vertices are
+           renamed (-o 1). The orientation follows from the positions.
 */
 
-struct NeighborListArray
+struct OrderFileHeader
 {
-    int vertex; //!< the vertex that owns this neighbor list
-    int* earlier; //!< an array of neighbors that come before this vertex in an ordering
-    int earlierDegree; //!< the number of neighbors in earlier
-    int* later; //!< an array of neighbors that come after this vertex in an ordering
-    int laterDegree; //!< an array of neighbors that come after this vertex in an ordering
-    int orderNumber; //!< the position of this verex in the ordering
+    char magic[8]; //!< ORDER_FILE_MAGIC
+    uint32_t version; //!< ORDER_FILE_VERSION
+    uint32_t headerSize; //!< sizeof(OrderFileHeader), where the positions begin
+    int64_t n; //!< the number of vertices
+    int64_t m; //!< the number of neighbors of the graph, 2x the number of edges
+    uint64_t graphChecksum; //!< csrChecksum of the graph the ordering was computed for
+    int32_t order; //!< the ORDER_ constant the ordering was computed with
+    int32_t degeneracy; //!< the exact degeneracy of the graph
+    double epsilon; //!< above 0 if the ordering is approximate (-e)
+    uint64_t reserved; //!< zero
 };
 
-typedef struct NeighborListArray NeighborListArray;
+typedef struct OrderFileHeader OrderFileHeader;
+
+/*! \brief the number of neighbors of a vertex that come after it.
+*/
+
+static inline int numLater(const OrientedGraph* orientedGraph, int vertex)
+{
+    return (int)(orientedGraph->laterOffsets[vertex+1] - orientedGraph->laterOffsets[vertex]);
+}
+
+/*! \brief the number of neighbors of a vertex that come before it.
+*/
+
+static inline int numEarlier(const OrientedGraph* orientedGraph, int vertex)
+{
+    return (int)(orientedGraph->earlierOffsets[vertex+1] - orientedGraph->earlierOffsets[vertex]);
+}
+
+/*! \brief decode the next neighbor of a list packed by compressOrientedGraph.
+
+    \param packed the read position in the packed list, advanced past the neighbor
+
+    \param previous the previously decoded neighbor, or -1 for the first one
+
+    \return the next neighbor
+*/
+
+static inline int unpackNextNeighbor(const unsigned char** packed, int previous)
+{
+    const unsigned char* p = *packed;
+    unsigned int gap = 0;
+    int shift = 0;
+    unsigned char byte;
+
+    // each byte holds 7 bits of the gap, lowest first; the high
+    // bit is set on every byte but the last
+    do
+    {
+        byte = *p++;
+        gap |= (unsigned int)(byte & 0x7F) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+
+    *packed = p;
+    return previous + 1 + (int)gap;
+}
+
+/*! \brief the name a vertex of an oriented graph has in the input graph.
+
+    \param orientedGraph an oriented graph
+
+    \param vertex a vertex of orientedGraph
+
+    \return vertex, translated back if vertices were renamed.
+*/
+
+static inline int originalVertex(OrientedGraph* orientedGraph, int vertex)
+{
+    return (orientedGraph->originalName == NULL) ? vertex : orientedGraph->originalName[vertex];
+}
+
+int computeDegeneracyPeeling(CSRGraph* graph, int* ordering, int* position);
+
+int computeDegeneracy(CSRGraph* graph);
+
+int parseVertexOrder(const char* name);
+
+const char* vertexOrderName(int order);
+
+void computeVertexOrder(CSRGraph* graph, int order, int* ordering, int* position);
+
+OrientedGraph* computeOrientedGraph(CSRGraph* graph, int* ordering, int* position, int renumber);
+
+int computeApproxDegeneracyPeeling(CSRGraph* graph, double epsilon, int* ordering, int* position);
+
+int computeCoreNumbers(CSRGraph* graph, int* core);
+
+CSRGraph* pruneToCore(CSRGraph* graph, int minCore, int** name);
+
+int writeOrderFile(const char* path, CSRGraph* graph, int* position, int order, double epsilon, int degeneracy);
 
-int computeDegeneracy(LinkedList** list, int size);
+int readOrderFile(const char* path, CSRGraph* graph, int* ordering, int* position,
+                  int* order, double* epsilon, int* degeneracy);
 
-NeighborList** computeDegeneracyOrderList(LinkedList** list, int size);
+void setOrientedGraphWeights(OrientedGraph* orientedGraph, int* weight);
 
-NeighborListArray** computeDegeneracyOrderArray(LinkedList** list, int size);
+void destroyOrientedGraph(OrientedGraph* orientedGraph);
 
-NeighborListArray **computeDegeneracyOrderArrayVerticesSorted(LinkedList **list, int size);
+long compressOrientedGraph(OrientedGraph* orientedGraph);
 
 int neighborListComparator(int* nl1, int* nl2);
 
@@ -0,0 +1,1550 @@
+/*
+    This file contains the algorithm for listing all cliques
+    according to the algorithm of Jain et al. specified in
+    "The power of pivoting for exact clique counting." (WSDM 2020).
+
+    This code is a modified version of the code of quick-cliques-1.0 library for counting
+    maximal cliques by Darren Strash (first name DOT last name AT gmail DOT com).
+
+    Original author: Darren Strash (first name DOT last name AT gmail DOT com)
+
+    Copyright (c) 2011 Darren Strash. This code is released under the GNU Public License (GPL) 3.0.
+
+    Modifications Copyright (c) 2020 Shweta Jain
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include<glob.h>
+#include<libgen.h>
+#include<limits.h>
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<fcntl.h>
+#include<unistd.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
+
+#include"misc.h"
+#include"MemoryManager.h"
+#include"graph_io.h"
+#include"graph_ingest.h"
+
+/*! \struct IngestChunk
+
+    \brief A newline-aligned piece of an input file in one of the
+           FORMAT_ formats, and the edges one thread found in it.
+*/
+
+struct IngestChunk
+{
+    const char* base; //!< the start of the mapped input, to turn ids into offsets
+    int file; //!< which input file the chunk is part of
+    const char* begin; //!< first byte of the chunk
+    const char* end; //!< one past the last byte of the chunk
+    int format; //!< one of the FORMAT_ constants
+    int countOnly; //!< FORMAT_METIS: only count the vertex lines in the chunk
+    int n; //!< FORMAT_EDGES, FORMAT_MTX, FORMAT_METIS: the number of vertices, to validate ids, or -1 if unknown
+    int maxId; //!< FORMAT_EDGES: the largest id found, to infer n
+    int metisSizes; //!< FORMAT_METIS: 1 if each line starts with a vertex size
+    int metisWeights; //!< FORMAT_METIS: the number of vertex weights on each line
+    int metisEdgeWeights; //!< FORMAT_METIS: 1 if each neighbor is followed by a weight
+    long firstVertex; //!< FORMAT_METIS: the vertex described by the chunk's first line
+    long numLines; //!< FORMAT_METIS: the number of vertex lines in the chunk
+    int* edges; //!< dense endpoints, two per edge (FORMAT_MTX, FORMAT_METIS)
+    TokenRef* tokens; //!< raw endpoints, two per edge (FORMAT_SNAP, FORMAT_CSV)
+    long numEdges; //!< the number of edges found
+    long capacity; //!< the number of edges edges or tokens has room for
+    const char* failedAt; //!< the start of a malformed line, or NULL
+};
+
+typedef struct IngestChunk IngestChunk;
+
+/*! \struct CompactShard
+
+    \brief The vertex ids with hash % numShards == shard, and the hash
+           table one thread uses to find the first occurrence of each.
+*/
+
+struct CompactShard
+{
+    const char* base; //!< the start of the mapped file
+    TokenRef* tokens; //!< all raw endpoints, in file order
+    long numTokens; //!< the number of raw endpoints
+    int shard; //!< which ids this thread owns
+    int numShards; //!< the number of threads
+    long* firstPos; //!< for each endpoint, the position of the first occurrence of its id
+    unsigned char* isFirst; //!< 1 at the position of the first occurrence of each id
+};
+
+typedef struct CompactShard CompactShard;
+
+/*! \struct MappedInputs
+
+    \brief One or more input files, mapped next to each other.
+*/
+
+struct MappedInputs
+{
+    int numFiles; //!< the number of files
+    char** paths; //!< the path of each file
+    char* base; //!< the start of the reserved address range, or NULL if all files are empty
+    size_t reserved; //!< the size of the reserved range
+    const char** data; //!< the first byte of each file
+    const char** begin; //!< the first byte of each file after its header, once it is read
+    const char** end; //!< one past the last byte of each file
+};
+
+typedef struct MappedInputs MappedInputs;
+
+/*! \struct RankBlock
+
+    \brief A block of endpoint positions, for the parallel prefix sum
+           that numbers ids by first occurrence.
+*/
+
+struct RankBlock
+{
+    long begin; //!< first position of the block
+    long end; //!< one past the last position of the block
+    int phase; //!< 0: count first occurrences, 1: number them, 2: relabel endpoints
+    long count; //!< the number of first occurrences in the block
+    long base; //!< the number of first occurrences before the block
+    unsigned char* isFirst; //!< 1 at the position of the first occurrence of each id
+    long* firstPos; //!< for each endpoint, the position of the first occurrence of its id
+    int* denseId; //!< at first occurrences, the dense id of the vertex
+    int* edges; //!< the dense endpoints to fill in
+};
+
+typedef struct RankBlock RankBlock;
+
+// the phases of simplifyEdgeArray
+#define SIMPLIFY_COUNT_KEYS 0 // count the edges that are not self-loops
+#define SIMPLIFY_WRITE_KEYS 1 // write their sort keys
+#define SIMPLIFY_HISTOGRAM 2 // count the keys with each value of one digit
+#define SIMPLIFY_SCATTER 3 // move the keys to their place by that digit
+#define SIMPLIFY_COUNT_GROUPS 4 // count the distinct edges among the sorted keys
+#define SIMPLIFY_WRITE_GROUPS 5 // write one copy of each back to the edge array
+
+#define RADIX_BITS 8
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+
+/*! \struct SimplifyBlock
+
+    \brief A block of edges or sort keys, and one thread's share of a
+           phase of simplifyEdgeArray.
+*/
+
+struct SimplifyBlock
+{
+    EdgeArray* edgeArray; //!< the edges being simplified
+    long begin; //!< first edge or key of the block
+    long end; //!< one past the last edge or key of the block
+    int phase; //!< one of the SIMPLIFY_ constants
+    uint64_t* keys; //!< the sort keys
+    uint64_t* buffer; //!< where SIMPLIFY_SCATTER moves the keys
+    long numKeys; //!< the number of sort keys
+    int shift; //!< the position of the radix digit
+    long* bucket; //!< RADIX_BUCKETS digit counts, then scatter positions
+    long count; //!< what the phase counted in this block
+    long base; //!< what the phase counted in the blocks before this one
+    long numBothDirections; //!< edges in this block given in both directions
+};
+
+typedef struct SimplifyBlock SimplifyBlock;
+
+/*! \struct FillBlock
+
+    \brief A block of edges one thread adds to a CSRGraph.
+*/
+
+struct FillBlock
+{
+    EdgeArray* edgeArray; //!< the edges
+    long begin; //!< first edge of the block
+    long end; //!< one past the last edge of the block
+    CSRGraph* graph; //!< the graph being built
+    long* cursor; //!< per-vertex next free slot in neighbors, or NULL to count degrees
+};
+
+typedef struct FillBlock FillBlock;
+
+/*! \brief map a format name to one of the FORMAT_ constants.
+
+    \param name one of edges, snap, csv, mtx, metis
+
+    \return the format, or -1 if the name is not known.
+*/
+
+int parseGraphFormat(const char* name)
+{
+    if (strcmp(name, "edges") == 0) return FORMAT_EDGES;
+    if (strcmp(name, "snap") == 0) return FORMAT_SNAP;
+    if (strcmp(name, "csv") == 0) return FORMAT_CSV;
+    if (strcmp(name, "mtx") == 0) return FORMAT_MTX;
+    if (strcmp(name, "metis") == 0) return FORMAT_METIS;
+    return -1;
+}
+
+/*! \brief whether vertex ids in a format are arbitrary, so that they
+           are compacted and an id map is written.
+
+    \param format one of the FORMAT_ constants
+
+    \return 1 for FORMAT_SNAP and FORMAT_CSV, 0 otherwise.
+*/
+
+int formatHasIdMap(int format)
+{
+    return (format == FORMAT_SNAP) || (format == FORMAT_CSV);
+}
+
+static int isBlank(char c)
+{
+    return (c == ' ') || (c == '\t') || (c == '\r');
+}
+
+/*! \brief find the end of the line starting at p.
+
+    \return the position of the newline, or end if there is none.
+*/
+
+static const char* findLineEnd(const char* p, const char* end)
+{
+    const char* newline = (const char *)memchr(p, '\n', end - p);
+    return newline ? newline : end;
+}
+
+/*! \brief find the next token on a line.
+
+    \param p the scan position, advanced past the token
+
+    \param eol the end of the line
+
+    \param comma 1 if commas separate tokens, in addition to blanks
+
+    \param token will point to the token
+
+    \param length will contain the length of the token
+
+    \return 1 if a token was found, 0 at the end of the line.
+*/
+
+static int nextToken(const char** p, const char* eol, int comma, const char** token, uint32_t* length)
+{
+    const char* s = *p;
+
+    while (s < eol && (isBlank(*s) || (comma && *s == ',')))
+        s++;
+
+    if (s == eol) return 0;
+
+    *token = s;
+    while (s < eol && !isBlank(*s) && !(comma && *s == ','))
+        s++;
+
+    *length = (uint32_t)(s - *token);
+    *p = s;
+    return 1;
+}
+
+/*! \brief parse a token as a non-negative decimal integer.
+
+    \return 1 on success, 0 if the token is not a number or too large.
+*/
+
+static int tokenToLong(const char* token, uint32_t length, long* value)
+{
+    long result = 0;
+    uint32_t i = 0;
+
+    if (length == 0) return 0;
+
+    for (i = 0; i < length; i++)
+    {
+        if (token[i] < '0' || token[i] > '9') return 0;
+        if (result > (LONG_MAX - 9)/10) return 0;
+        result = result*10 + (token[i] - '0');
+    }
+
+    *value = result;
+    return 1;
+}
+
+/*! \brief 32-bit FNV-1a hash of a vertex id.
+*/
+
+static uint32_t hashToken(const char* token, uint32_t length)
+{
+    uint32_t hash = 2166136261u;
+    uint32_t i = 0;
+
+    for (i = 0; i < length; i++)
+        hash = (hash ^ (unsigned char)token[i]) * 16777619u;
+
+    return hash;
+}
+
+/*! \brief make room for one more edge in a chunk.
+*/
+
+static void growChunk(IngestChunk* chunk)
+{
+    if (chunk->numEdges < chunk->capacity) return;
+
+    chunk->capacity *= 2;
+    if (chunk->tokens != NULL)
+        chunk->tokens = (TokenRef *)Realloc(chunk->tokens, 2*chunk->capacity*sizeof(TokenRef));
+    else
+        chunk->edges = (int *)Realloc(chunk->edges, 2*chunk->capacity*sizeof(int));
+}
+
+/*! \brief parse the lines of one chunk according to its format; run
+           as a thread.
+
+    \param arg the IngestChunk to fill in.
+*/
+
+static void* ingestChunk(void* arg)
+{
+    IngestChunk* chunk = (IngestChunk*)arg;
+    const char* p = chunk->begin;
+    long vertex = chunk->firstVertex;
+    int comma = (chunk->format == FORMAT_CSV);
+
+    chunk->numEdges = 0;
+    chunk->numLines = 0;
+    chunk->maxId = -1;
+    chunk->failedAt = NULL;
+
+    if (!chunk->countOnly)
+    {
+        chunk->capacity = (chunk->end - chunk->begin)/8 + 16;
+        if (formatHasIdMap(chunk->format))
+            chunk->tokens = (TokenRef *)Malloc(2*chunk->capacity*sizeof(TokenRef));
+        else
+            chunk->edges = (int *)Malloc(2*chunk->capacity*sizeof(int));
+    }
+
+    while (p < chunk->end && chunk->failedAt == NULL)
+    {
+        const char* eol = findLineEnd(p, chunk->end);
+        const char* q = p;
+        const char* token[2];
+        uint32_t length[2];
+        long id[2];
+
+        while (q < eol && isBlank(*q)) q++;
+
+        int comment = (q < eol) && ((*q == '%') || (*q == '#' && chunk->format != FORMAT_METIS));
+
+        if (comment)
+        {
+            // nothing to do
+        }
+        else if (chunk->format == FORMAT_METIS)
+        {
+            // every other line describes the next vertex, even an empty one
+            chunk->numLines++;
+
+            if (!chunk->countOnly)
+            {
+                int skip = chunk->metisSizes + chunk->metisWeights;
+                int i = 0;
+
+                for (i = 0; i < skip && nextToken(&q, eol, 0, &token[0], &length[0]); i++);
+
+                while (nextToken(&q, eol, 0, &token[0], &length[0]))
+                {
+                    if (vertex >= chunk->n || !tokenToLong(token[0], length[0], &id[0])
+                        || id[0] < 1 || id[0] > chunk->n)
+                    {
+                        chunk->failedAt = p;
+                        break;
+                    }
+
+                    growChunk(chunk);
+                    chunk->edges[2*chunk->numEdges] = (int)vertex;
+                    chunk->edges[2*chunk->numEdges+1] = (int)(id[0] - 1);
+                    chunk->numEdges++;
+
+                    if (chunk->metisEdgeWeights)
+                        nextToken(&q, eol, 0, &token[0], &length[0]);
+                }
+            }
+
+            vertex++;
+        }
+        else if (nextToken(&q, eol, comma, &token[0], &length[0]))
+        {
+            if (!nextToken(&q, eol, comma, &token[1], &length[1]))
+            {
+                // a line with a single number is a header line of the
+                // comma separated format; anywhere else it is an error
+                if (!formatHasIdMap(chunk->format)) chunk->failedAt = p;
+            }
+            else if (chunk->format == FORMAT_MTX || chunk->format == FORMAT_EDGES)
+            {
+                // MatrixMarket ids start at 1, .edges ids at 0
+                long first = (chunk->format == FORMAT_MTX) ? 1 : 0;
+                long last = (chunk->n >= 0) ? chunk->n - 1 + first : INT_MAX - 1;
+
+                if (!tokenToLong(token[0], length[0], &id[0]) || !tokenToLong(token[1], length[1], &id[1])
+                    || id[0] < first || id[0] > last || id[1] < first || id[1] > last)
+                {
+                    chunk->failedAt = p;
+                }
+                else
+                {
+                    growChunk(chunk);
+                    chunk->edges[2*chunk->numEdges] = (int)(id[0] - first);
+                    chunk->edges[2*chunk->numEdges+1] = (int)(id[1] - first);
+                    chunk->maxId = max(chunk->maxId, (int)max(id[0], id[1]) - (int)first);
+                    chunk->numEdges++;
+                }
+            }
+            else
+            {
+                growChunk(chunk);
+                int i = 0;
+                for (i = 0; i < 2; i++)
+                {
+                    TokenRef* ref = &chunk->tokens[2*chunk->numEdges+i];
+                    ref->offset = (uint64_t)(token[i] - chunk->base);
+                    ref->length = length[i];
+                    ref->hash = hashToken(token[i], length[i]);
+                }
+                chunk->numEdges++;
+            }
+        }
+
+        p = (eol < chunk->end) ? eol + 1 : eol;
+    }
+
+    return NULL;
+}
+
+/*! \brief whether two raw endpoints name the same vertex.
+*/
+
+static int sameToken(const char* base, TokenRef* a, TokenRef* b)
+{
+    return (a->hash == b->hash) && (a->length == b->length)
+        && (memcmp(base + a->offset, base + b->offset, a->length) == 0);
+}
+
+/*! \brief find the first occurrence of every id owned by a shard with
+           an open addressing hash table; run as a thread.
+
+    \param arg the CompactShard to process.
+*/
+
+static void* compactShard(void* arg)
+{
+    CompactShard* shard = (CompactShard*)arg;
+    int bits = 10;
+    long capacity = 1L << bits;
+    long numKeys = 0;
+
+    // each cell holds 1 + the position of an id's first occurrence, or 0
+    long* table = (long *)Calloc(capacity, sizeof(long));
+    long pos = 0;
+
+    for (pos = 0; pos < shard->numTokens; pos++)
+    {
+        TokenRef* token = &shard->tokens[pos];
+        if ((int)(token->hash % shard->numShards) != shard->shard) continue;
+
+        if (2*(numKeys+1) > capacity)
+        {
+            long* oldTable = table;
+            long oldCapacity = capacity;
+            long i = 0;
+
+            bits++;
+            capacity = 1L << bits;
+            table = (long *)Calloc(capacity, sizeof(long));
+
+            for (i = 0; i < oldCapacity; i++)
+            {
+                if (oldTable[i] == 0) continue;
+                uint64_t slot = ((uint64_t)shard->tokens[oldTable[i]-1].hash * 0x9E3779B97F4A7C15ULL) >> (64 - bits);
+                while (table[slot] != 0) slot = (slot + 1) & (capacity - 1);
+                table[slot] = oldTable[i];
+            }
+
+            Free(oldTable);
+        }
+
+        uint64_t slot = ((uint64_t)token->hash * 0x9E3779B97F4A7C15ULL) >> (64 - bits);
+        while (1)
+        {
+            long cell = table[slot];
+            if (cell == 0)
+            {
+                table[slot] = pos + 1;
+                shard->firstPos[pos] = pos;
+                shard->isFirst[pos] = 1;
+                numKeys++;
+                break;
+            }
+            if (sameToken(shard->base, &shard->tokens[cell-1], token))
+            {
+                shard->firstPos[pos] = cell - 1;
+                break;
+            }
+            slot = (slot + 1) & (capacity - 1);
+        }
+    }
+
+    Free(table);
+    return NULL;
+}
+
+/*! \brief one phase of numbering ids by first occurrence; run as a thread.
+
+    \param arg the RankBlock to process.
+*/
+
+static void* rankBlock(void* arg)
+{
+    RankBlock* block = (RankBlock*)arg;
+    long pos = 0;
+
+    if (block->phase == 0)
+    {
+        block->count = 0;
+        for (pos = block->begin; pos < block->end; pos++)
+            block->count += block->isFirst[pos];
+    }
+    else if (block->phase == 1)
+    {
+        long next = block->base;
+        for (pos = block->begin; pos < block->end; pos++)
+            if (block->isFirst[pos]) block->denseId[pos] = (int)next++;
+    }
+    else
+    {
+        for (pos = block->begin; pos < block->end; pos++)
+            block->edges[pos] = block->denseId[block->firstPos[pos]];
+    }
+
+    return NULL;
+}
+
+/*! \brief replace raw endpoints by dense ids 0..n-1, numbered in order of
+           first occurrence in the file (the numbering python/sanitize.py
+           used), and optionally write the id map.
+
+    \param base the start of the mapped file
+
+    \param tokens the raw endpoints, two per edge
+
+    \param numTokens the number of raw endpoints
+
+    \param edges will contain the dense endpoints
+
+    \param idMapPath where to write the original id of each dense id, one
+                     per line, or NULL
+
+    \return the number of distinct ids
+*/
+
+static int compactIds(const char* base, TokenRef* tokens, long numTokens, int* edges, const char* idMapPath)
+{
+    int numThreads = numLoaderThreads(numTokens*sizeof(TokenRef));
+    long* firstPos = (long *)Malloc(numTokens*sizeof(long));
+    unsigned char* isFirst = (unsigned char *)Calloc(numTokens, sizeof(unsigned char));
+    int* denseId = (int *)Malloc(numTokens*sizeof(int));
+    int i = 0;
+
+    CompactShard* shards = (CompactShard *)Calloc(numThreads, sizeof(CompactShard));
+    for (i = 0; i < numThreads; i++)
+    {
+        shards[i].base = base;
+        shards[i].tokens = tokens;
+        shards[i].numTokens = numTokens;
+        shards[i].shard = i;
+        shards[i].numShards = numThreads;
+        shards[i].firstPos = firstPos;
+        shards[i].isFirst = isFirst;
+    }
+
+    runThreads(compactShard, shards, sizeof(CompactShard), numThreads);
+    Free(shards);
+
+    RankBlock* blocks = (RankBlock *)Calloc(numThreads, sizeof(RankBlock));
+    for (i = 0; i < numThreads; i++)
+    {
+        blocks[i].begin = numTokens*i/numThreads;
+        blocks[i].end = numTokens*(i+1)/numThreads;
+        blocks[i].isFirst = isFirst;
+        blocks[i].firstPos = firstPos;
+        blocks[i].denseId = denseId;
+        blocks[i].edges = edges;
+    }
+
+    runThreads(rankBlock, blocks, sizeof(RankBlock), numThreads);
+
+    long numIds = 0;
+    for (i = 0; i < numThreads; i++)
+    {
+        blocks[i].base = numIds;
+        numIds += blocks[i].count;
+        blocks[i].phase = 1;
+    }
+
+    runThreads(rankBlock, blocks, sizeof(RankBlock), numThreads);
+
+    for (i = 0; i < numThreads; i++)
+        blocks[i].phase = 2;
+
+    runThreads(rankBlock, blocks, sizeof(RankBlock), numThreads);
+    Free(blocks);
+
+    if (idMapPath != NULL)
+    {
+        FILE* fp = fopen(idMapPath, "w");
+        if (!fp)
+        {
+            fprintf(stderr, "Could not write id map %s.\n", idMapPath);
+        }
+        else
+        {
+            long pos = 0;
+            for (pos = 0; pos < numTokens; pos++)
+            {
+                if (!isFirst[pos]) continue;
+                fwrite(base + tokens[pos].offset, 1, tokens[pos].length, fp);
+                fputc('\n', fp);
+            }
+            fclose(fp);
+        }
+    }
+
+    Free(firstPos);
+    Free(isFirst);
+    Free(denseId);
+
+    if (numIds > INT_MAX)
+    {
+        fprintf(stderr, "Too many distinct vertex ids in input file.\n");
+        exit(1);
+    }
+
+    return (int)numIds;
+}
+
+/*! \brief read the header line of a MatrixMarket or METIS file, after
+           any comment lines.
+
+    \param p the scan position, advanced past the header line
+
+    \param end the end of the file
+
+    \param values will contain up to four numbers from the header line; a
+                  METIS fmt field is kept as its decimal digits, e.g. 11
+
+    \return the number of values read, or -1 if the line is malformed.
+*/
+
+static int readHeaderLine(const char** p, const char* end, long* values)
+{
+    while (*p < end)
+    {
+        const char* eol = findLineEnd(*p, end);
+        const char* q = *p;
+        const char* token;
+        uint32_t length;
+        int numValues = 0;
+
+        *p = (eol < end) ? eol + 1 : eol;
+
+        while (q < eol && isBlank(*q)) q++;
+        if (q == eol || *q == '%') continue;
+
+        while (numValues < 4 && nextToken(&q, eol, 0, &token, &length))
+        {
+            if (!tokenToLong(token, length, &values[numValues])) return -1;
+            numValues++;
+        }
+
+        return numValues;
+    }
+
+    return -1;
+}
+
+/*! \brief map input files next to each other in one reserved range of
+           address space, so that a single base pointer (and TokenRef
+           offsets from it) covers all of them. Exits the program if a
+           file cannot be read.
+
+    \param paths the files to map
+
+    \param numPaths the number of files
+
+    \param inputs will describe the mapped files when this function returns
+*/
+
+static void mapInputFiles(char** paths, int numPaths, MappedInputs* inputs)
+{
+    size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+    int* fds = (int *)Calloc(numPaths, sizeof(int));
+    int i = 0;
+
+    inputs->numFiles = numPaths;
+    inputs->paths = paths;
+    inputs->data = (const char **)Calloc(numPaths, sizeof(char*));
+    inputs->begin = (const char **)Calloc(numPaths, sizeof(char*));
+    inputs->end = (const char **)Calloc(numPaths, sizeof(char*));
+    inputs->reserved = 0;
+
+    size_t* offsets = (size_t *)Calloc(numPaths, sizeof(size_t));
+    size_t* sizes = (size_t *)Calloc(numPaths, sizeof(size_t));
+
+    for (i = 0; i < numPaths; i++)
+    {
+        struct stat fileStat;
+        fds[i] = open(paths[i], O_RDONLY);
+        if (fds[i] < 0 || fstat(fds[i], &fileStat) != 0)
+        {
+            fprintf(stderr, "Could not open input file %s.\n", paths[i]);
+            exit(1);
+        }
+
+        sizes[i] = (size_t)fileStat.st_size;
+        offsets[i] = inputs->reserved;
+        inputs->reserved += (sizes[i] + pageSize - 1)/pageSize*pageSize;
+    }
+
+    inputs->base = NULL;
+    if (inputs->reserved > 0)
+    {
+        inputs->base = (char *)mmap(NULL, inputs->reserved, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (inputs->base == MAP_FAILED)
+        {
+            fprintf(stderr, "Could not map input file.\n");
+            exit(1);
+        }
+    }
+
+    for (i = 0; i < numPaths; i++)
+    {
+        inputs->data[i] = inputs->base + offsets[i];
+        inputs->begin[i] = inputs->data[i];
+        inputs->end[i] = inputs->begin[i] + sizes[i];
+
+        if (sizes[i] > 0)
+        {
+            void* data = mmap(inputs->base + offsets[i], sizes[i], PROT_READ, MAP_PRIVATE | MAP_FIXED, fds[i], 0);
+            if (data == MAP_FAILED)
+            {
+                fprintf(stderr, "Could not map input file %s.\n", paths[i]);
+                exit(1);
+            }
+            madvise(data, sizes[i], MADV_SEQUENTIAL);
+        }
+
+        close(fds[i]);
+    }
+
+    Free(fds);
+    Free(offsets);
+    Free(sizes);
+}
+
+/*! \brief unmap files mapped with mapInputFiles.
+
+    \param inputs the mapped files
+*/
+
+static void unmapInputFiles(MappedInputs* inputs)
+{
+    if (inputs->base != NULL) munmap(inputs->base, inputs->reserved);
+    Free(inputs->data);
+    Free(inputs->begin);
+    Free(inputs->end);
+}
+
+/*! \brief read a graph from one or more files in one of the FORMAT_
+           formats, parsing newline-aligned chunks of all files
+           concurrently. SNAP and comma separated ids may be any strings
+           (or 64-bit integers); they are compacted to 0..n-1 across all
+           files. MatrixMarket and METIS ids are 1-based and shifted to
+           0-based. FORMAT_EDGES files are read as headerless shards of
+           "u v" lines.
+
+    \param paths the input files, in order
+
+    \param numPaths the number of files. MatrixMarket and METIS input must
+                    be a single file.
+
+    \param format one of the FORMAT_ constants
+
+    \param n FORMAT_EDGES: the number of vertices, or -1 to take it from
+             the largest id. Ignored by other formats.
+
+    \param idMapPath where to write the original id of each vertex, or NULL.
+                     Only used by formats for which formatHasIdMap is 1.
+
+    \return the edges as they appear in the files, possibly with self-loops,
+            duplicates and both directions of an edge. Exits the program
+            if a file cannot be read or a line is malformed.
+*/
+
+EdgeArray* ingestEdgeFiles(char** paths, int numPaths, int format, int n, const char* idMapPath)
+{
+    MappedInputs inputs;
+    long header[4] = {0, 0, 0, 0};
+    int numHeader = 0;
+    int i = 0;
+    int file = 0;
+
+    if (numPaths > 1 && (format == FORMAT_MTX || format == FORMAT_METIS))
+    {
+        fprintf(stderr, "MatrixMarket and METIS input cannot be split into shards.\n");
+        exit(1);
+    }
+
+    mapInputFiles(paths, numPaths, &inputs);
+
+    if (format == FORMAT_MTX || format == FORMAT_METIS)
+    {
+        numHeader = readHeaderLine(&inputs.begin[0], inputs.end[0], header);
+        if (numHeader < ((format == FORMAT_MTX) ? 3 : 2))
+        {
+            fprintf(stderr, "problem with header line in input file\n");
+            exit(1);
+        }
+
+        long numVertices = (format == FORMAT_MTX) ? max(header[0], header[1]) : header[0];
+        if (numVertices > INT_MAX)
+        {
+            fprintf(stderr, "problem with header line in input file\n");
+            exit(1);
+        }
+        n = (int)numVertices;
+    }
+    else if (format != FORMAT_EDGES)
+    {
+        n = 0;
+    }
+
+    // cut every file into pieces of about the same size, so that
+    // many small shards and one big file keep all threads busy
+    size_t totalBytes = 0;
+    for (file = 0; file < numPaths; file++)
+        totalBytes += inputs.end[file] - inputs.begin[file];
+
+    int numThreads = numLoaderThreads(totalBytes);
+    size_t chunkBytes = totalBytes/numThreads + 1;
+    int numChunks = 0;
+
+    for (file = 0; file < numPaths; file++)
+        numChunks += (int)((inputs.end[file] - inputs.begin[file] + chunkBytes - 1)/chunkBytes);
+
+    IngestChunk* chunks = (IngestChunk *)Calloc(max(numChunks, 1), sizeof(IngestChunk));
+    int numFileChunks = 0;
+    numChunks = 0;
+
+    for (file = 0; file < numPaths; file++)
+    {
+        const char* body = inputs.begin[file];
+        const char* end = inputs.end[file];
+        const char* chunkBegin = body;
+
+        numFileChunks = (int)((end - body + chunkBytes - 1)/chunkBytes);
+
+        for (i = 0; i < numFileChunks; i++)
+        {
+            const char* chunkEnd = end;
+            if (i < numFileChunks - 1)
+            {
+                chunkEnd = body + (size_t)(end - body)*(i+1)/numFileChunks;
+                if (chunkEnd < chunkBegin) chunkEnd = chunkBegin;
+                chunkEnd = findLineEnd(chunkEnd, end);
+                if (chunkEnd < end) chunkEnd++;
+            }
+
+            IngestChunk* chunk = &chunks[numChunks++];
+            chunk->base = inputs.base;
+            chunk->file = file;
+            chunk->begin = chunkBegin;
+            chunk->end = chunkEnd;
+            chunk->format = format;
+            chunk->n = n;
+            chunkBegin = chunkEnd;
+
+            if (format == FORMAT_METIS)
+            {
+                // fmt is up to three flags: vertex sizes, vertex weights, edge weights
+                long fmt = (numHeader > 2) ? header[2] : 0;
+                chunk->metisSizes = (int)((fmt / 100) % 10);
+                chunk->metisWeights = ((fmt / 10) % 10) ? (int)((numHeader > 3) ? header[3] : 1) : 0;
+                chunk->metisEdgeWeights = (int)(fmt % 10);
+            }
+        }
+    }
+
+    // a METIS line describes a vertex by its position, so count the
+    // vertex lines of every chunk before parsing any of them
+    if (format == FORMAT_METIS)
+    {
+        for (i = 0; i < numChunks; i++)
+            chunks[i].countOnly = 1;
+
+        runTasks(ingestChunk, chunks, sizeof(IngestChunk), numChunks, numThreads);
+
+        long firstVertex = 0;
+        for (i = 0; i < numChunks; i++)
+        {
+            chunks[i].countOnly = 0;
+            chunks[i].firstVertex = firstVertex;
+            firstVertex += chunks[i].numLines;
+        }
+    }
+
+    runTasks(ingestChunk, chunks, sizeof(IngestChunk), numChunks, numThreads);
+
+    long numEdges = 0;
+    int maxId = -1;
+    for (i = 0; i < numChunks; i++)
+    {
+        if (chunks[i].failedAt != NULL)
+        {
+            long line = 1;
+            const char* c = inputs.data[chunks[i].file];
+            for (; c < chunks[i].failedAt; c++)
+                if (*c == '\n') line++;
+
+            if (numPaths > 1)
+                fprintf(stderr, "problem with line %ld in input file %s\n", line, paths[chunks[i].file]);
+            else
+                fprintf(stderr, "problem with line %ld in input file\n", line);
+            exit(1);
+        }
+
+        numEdges += chunks[i].numEdges;
+        maxId = max(maxId, chunks[i].maxId);
+    }
+
+    EdgeArray* edgeArray = (EdgeArray *)Malloc(sizeof(EdgeArray));
+    edgeArray->n = (n >= 0) ? n : maxId + 1;
+    edgeArray->numEdges = numEdges;
+    edgeArray->edges = (int *)Malloc(max(2*numEdges, 1)*sizeof(int));
+
+    long next = 0;
+    if (formatHasIdMap(format))
+    {
+        TokenRef* tokens = (TokenRef *)Malloc(max(2*numEdges, 1)*sizeof(TokenRef));
+        for (i = 0; i < numChunks; i++)
+        {
+            memcpy(tokens + 2*next, chunks[i].tokens, 2*chunks[i].numEdges*sizeof(TokenRef));
+            next += chunks[i].numEdges;
+            Free(chunks[i].tokens);
+        }
+
+        edgeArray->n = compactIds(inputs.base, tokens, 2*numEdges, edgeArray->edges, idMapPath);
+        Free(tokens);
+    }
+    else
+    {
+        for (i = 0; i < numChunks; i++)
+        {
+            memcpy(edgeArray->edges + 2*next, chunks[i].edges, 2*chunks[i].numEdges*sizeof(int));
+            next += chunks[i].numEdges;
+            Free(chunks[i].edges);
+        }
+    }
+
+    Free(chunks);
+    unmapInputFiles(&inputs);
+
+    return edgeArray;
+}
+
+/*! \brief read a graph from a single file; see ingestEdgeFiles.
+*/
+
+EdgeArray* ingestEdgeFile(char* fpath, int format, const char* idMapPath)
+{
+    return ingestEdgeFiles(&fpath, 1, format, -1, idMapPath);
+}
+
+/*! \brief whether an input path names a set of shards rather than a
+           single file: a directory, or a glob pattern that is not itself
+           the name of a file.
+
+    \param fpath the -i argument
+
+    \return 1 for a directory or glob pattern, 0 otherwise
+*/
+
+int isShardedInput(const char* fpath)
+{
+    struct stat pathStat;
+
+    if (stat(fpath, &pathStat) == 0)
+        return S_ISDIR(pathStat.st_mode) ? 1 : 0;
+
+    return strpbrk(fpath, "*?[") != NULL;
+}
+
+/*! \brief whether a file name ends with a suffix.
+*/
+
+static int hasSuffix(const char* name, const char* suffix)
+{
+    size_t nameLength = strlen(name);
+    size_t suffixLength = strlen(suffix);
+
+    return nameLength >= suffixLength && strcmp(name + nameLength - suffixLength, suffix) == 0;
+}
+
+/*! \brief list the shards of a sharded input and read its manifest.
+
+    \param fpath a directory, whose files are all shards, or a glob pattern
+                 matching the shards. The manifest, CSR caches and id maps
+                 are never taken as shards.
+
+    \param numShards will contain the number of shards
+
+    \param directory will contain a newly allocated copy of the directory
+                     holding the shards, without a trailing slash
+
+    \param manifestN will contain n from the manifest, or -1 if there is none
+
+    \param manifestM will contain m from the manifest, or -1 if there is none
+
+    \return a newly allocated array of newly allocated paths, sorted by name.
+            Exits the program if no shard is found.
+*/
+
+char** listShards(const char* fpath, int* numShards, char** directory, long* manifestN, long* manifestM)
+{
+    struct stat pathStat;
+    int isDirectory = (stat(fpath, &pathStat) == 0) && S_ISDIR(pathStat.st_mode);
+
+    char* copy = (char *)Calloc(strlen(fpath) + 1, sizeof(char));
+    strcpy(copy, fpath);
+
+    size_t length = strlen(copy);
+    while (length > 1 && copy[length-1] == '/')
+        copy[--length] = '\0';
+
+    if (isDirectory)
+    {
+        *directory = copy;
+    }
+    else
+    {
+        *directory = (char *)Calloc(length + 1, sizeof(char));
+        strcpy(*directory, copy);
+
+        // dirname may return its argument, edited in place, so the
+        // parent can overlap *directory
+        char* parent = dirname(*directory);
+        memmove(*directory, parent, strlen(parent) + 1);
+    }
+
+    char* pattern = (char *)Calloc(length + 3, sizeof(char));
+    strcpy(pattern, copy);
+    if (isDirectory) strcat(pattern, "/*");
+
+    char* manifestPath = (char *)Calloc(strlen(*directory) + strlen(SHARD_MANIFEST) + 2, sizeof(char));
+    sprintf(manifestPath, "%s/%s", *directory, SHARD_MANIFEST);
+
+    *manifestN = -1;
+    *manifestM = -1;
+    FILE* fp = fopen(manifestPath, "r");
+    if (fp)
+    {
+        if (fscanf(fp, "%ld %ld", manifestN, manifestM) != 2 || *manifestN < 0 || *manifestN > INT_MAX)
+        {
+            fprintf(stderr, "problem with shard manifest %s\n", manifestPath);
+            exit(1);
+        }
+        fclose(fp);
+    }
+
+    glob_t matches;
+    char** shards = NULL;
+    *numShards = 0;
+
+    if (glob(pattern, 0, NULL, &matches) == 0)
+    {
+        size_t i = 0;
+        shards = (char **)Calloc(matches.gl_pathc, sizeof(char*));
+
+        for (i = 0; i < matches.gl_pathc; i++)
+        {
+            const char* path = matches.gl_pathv[i];
+            struct stat shardStat;
+
+            if (stat(path, &shardStat) != 0 || !S_ISREG(shardStat.st_mode)) continue;
+            if (strcmp(path, manifestPath) == 0) continue;
+            if (hasSuffix(path, CSR_CACHE_SUFFIX) || hasSuffix(path, IDMAP_SUFFIX)) continue;
+
+            shards[*numShards] = (char *)Calloc(strlen(path) + 1, sizeof(char));
+            strcpy(shards[*numShards], path);
+            (*numShards)++;
+        }
+
+        globfree(&matches);
+    }
+
+    if (*numShards == 0)
+    {
+        fprintf(stderr, "Could not find any input files matching %s.\n", fpath);
+        exit(1);
+    }
+
+    if (!isDirectory) Free(copy);
+    Free(pattern);
+    Free(manifestPath);
+
+    return shards;
+}
+
+/*! \brief load a graph split into shards, parsing all of them
+           concurrently. Shards in the edges format have no header line;
+           n and m are read from a manifest file (SHARD_MANIFEST, holding
+           "n m") next to the shards, or else inferred from the largest
+           id and the number of lines. For a directory, a CSR cache is
+           kept next to it (directory + CSR_CACHE_SUFFIX), and it is
+           reused while the total size and latest modification time of
+           the shards do not change.
+
+    \param fpath a directory or glob pattern, see listShards
+
+    \param format one of FORMAT_EDGES, FORMAT_SNAP, FORMAT_CSV
+
+    \return the graph in compressed sparse row format
+*/
+
+CSRGraph* loadShardedGraphCSR(char* fpath, int format)
+{
+    int numShards = 0;
+    char* directory = NULL;
+    long manifestN = -1;
+    long manifestM = -1;
+    char** shards = listShards(fpath, &numShards, &directory, &manifestN, &manifestM);
+    struct stat pathStat;
+    int i = 0;
+
+    // a cache is only valid for the same shards, so describe them
+    // all by their total size and latest modification time
+    struct stat sourceStat;
+    memset(&sourceStat, 0, sizeof(struct stat));
+    for (i = 0; i < numShards; i++)
+    {
+        struct stat shardStat;
+        stat(shards[i], &shardStat);
+        sourceStat.st_size += shardStat.st_size;
+        if (shardStat.st_mtime > sourceStat.st_mtime) sourceStat.st_mtime = shardStat.st_mtime;
+    }
+
+    char* cachePath = NULL;
+    if (stat(fpath, &pathStat) == 0 && S_ISDIR(pathStat.st_mode))
+    {
+        cachePath = (char *)Calloc(strlen(directory) + strlen(CSR_CACHE_SUFFIX) + 1, sizeof(char));
+        strcpy(cachePath, directory);
+        strcat(cachePath, CSR_CACHE_SUFFIX);
+    }
+
+    CSRGraph* graph = NULL;
+    if (cachePath != NULL && (graph = readCSRCache(cachePath, &sourceStat, format)) != NULL)
+    {
+        printf("Loaded graph from %s.\n", cachePath);
+    }
+    else
+    {
+        char* idMapPath = NULL;
+        if (formatHasIdMap(format))
+        {
+            idMapPath = (char *)Calloc(strlen(directory) + strlen(IDMAP_SUFFIX) + 1, sizeof(char));
+            strcpy(idMapPath, directory);
+            strcat(idMapPath, IDMAP_SUFFIX);
+        }
+
+        printf("Reading %d shards.\n", numShards);
+        EdgeArray* edgeArray = ingestEdgeFiles(shards, numShards, format, (int)manifestN, idMapPath);
+
+        if (manifestM >= 0 && edgeArray->numEdges != manifestM)
+        {
+            fprintf(stderr, "The shard manifest promises %ld edges, but the shards hold %ld.\n",
+                    manifestM, edgeArray->numEdges);
+            exit(1);
+        }
+
+        simplifyEdgeArray(edgeArray);
+        graph = csrFromEdgeArray(edgeArray);
+        destroyEdgeArray(edgeArray);
+
+        if (idMapPath != NULL)
+        {
+            printf("Wrote original vertex ids to %s.\n", idMapPath);
+            Free(idMapPath);
+        }
+
+        if (cachePath != NULL && !writeCSRCache(graph, cachePath, &sourceStat, format))
+            fprintf(stderr, "Could not write graph cache %s.\n", cachePath);
+    }
+
+    for (i = 0; i < numShards; i++)
+        Free(shards[i]);
+    Free(shards);
+    Free(directory);
+    if (cachePath != NULL) Free(cachePath);
+
+    return graph;
+}
+
+/*! \brief the number of bits needed to write x in binary.
+*/
+
+static int bitsFor(uint64_t x)
+{
+    int bits = 0;
+    while (x > 0)
+    {
+        bits++;
+        x >>= 1;
+    }
+    return bits;
+}
+
+/*! \brief the key an edge is sorted by: (min << 32) | (max << 1) | dir,
+           where dir is 1 if the edge was given as (max, min). Copies of
+           the same undirected edge sort next to each other, and a copy
+           given as (min, max) sorts first.
+*/
+
+static uint64_t edgeKey(uint32_t u, uint32_t v)
+{
+    return (u < v) ? (((uint64_t)u << 32) | ((uint64_t)v << 1))
+                   : (((uint64_t)v << 32) | ((uint64_t)u << 1) | 1);
+}
+
+/*! \brief one phase of simplifyEdgeArray on one block; run as a thread.
+
+    \param arg the SimplifyBlock to process.
+*/
+
+static void* simplifyBlock(void* arg)
+{
+    SimplifyBlock* block = (SimplifyBlock*)arg;
+    int* edges = block->edgeArray->edges;
+    uint64_t* keys = block->keys;
+    long i = 0;
+
+    if (block->phase == SIMPLIFY_COUNT_KEYS || block->phase == SIMPLIFY_WRITE_KEYS)
+    {
+        long next = block->base;
+        block->count = 0;
+
+        for (i = block->begin; i < block->end; i++)
+        {
+            if (edges[2*i] == edges[2*i+1]) continue;
+            if (block->phase == SIMPLIFY_WRITE_KEYS)
+                keys[next++] = edgeKey((uint32_t)edges[2*i], (uint32_t)edges[2*i+1]);
+            block->count++;
+        }
+    }
+    else if (block->phase == SIMPLIFY_HISTOGRAM)
+    {
+        memset(block->bucket, 0, RADIX_BUCKETS*sizeof(long));
+        for (i = block->begin; i < block->end; i++)
+            block->bucket[(keys[i] >> block->shift) & (RADIX_BUCKETS - 1)]++;
+    }
+    else if (block->phase == SIMPLIFY_SCATTER)
+    {
+        // bucket now holds where this block's first key of each digit goes
+        for (i = block->begin; i < block->end; i++)
+            block->buffer[block->bucket[(keys[i] >> block->shift) & (RADIX_BUCKETS - 1)]++] = keys[i];
+    }
+    else
+    {
+        // a group of copies of one edge belongs to the block it starts in
+        long numKeys = block->numKeys;
+        long next = block->base;
+        block->count = 0;
+        block->numBothDirections = 0;
+
+        for (i = block->begin; i < block->end; i++)
+        {
+            if (i > 0 && (keys[i] >> 1) == (keys[i-1] >> 1)) continue;
+
+            if (block->phase == SIMPLIFY_COUNT_GROUPS)
+            {
+                long last = i;
+                while (last + 1 < numKeys && (keys[last+1] >> 1) == (keys[i] >> 1))
+                    last++;
+                if ((keys[i] & 1) == 0 && (keys[last] & 1) == 1)
+                    block->numBothDirections++;
+            }
+            else
+            {
+                edges[2*next] = (int)(keys[i] >> 32);
+                edges[2*next+1] = (int)((keys[i] & 0xFFFFFFFFu) >> 1);
+                next++;
+            }
+
+            block->count++;
+        }
+    }
+
+    return NULL;
+}
+
+/*! \brief run one phase of simplifyEdgeArray on all blocks and set each
+           block's base to the total count of the blocks before it.
+
+    \return the total count of all blocks
+*/
+
+static long runSimplifyPhase(SimplifyBlock* blocks, int numThreads, int phase)
+{
+    long total = 0;
+    int i = 0;
+
+    for (i = 0; i < numThreads; i++)
+        blocks[i].phase = phase;
+
+    runThreads(simplifyBlock, blocks, sizeof(SimplifyBlock), numThreads);
+
+    for (i = 0; i < numThreads; i++)
+    {
+        blocks[i].base = total;
+        total += blocks[i].count;
+    }
+
+    return total;
+}
+
+/*! \brief split [0, total) into one block per thread.
+*/
+
+static void splitBlocks(SimplifyBlock* blocks, int numThreads, long total)
+{
+    int i = 0;
+    for (i = 0; i < numThreads; i++)
+    {
+        blocks[i].begin = total*i/numThreads;
+        blocks[i].end = total*(i+1)/numThreads;
+    }
+}
+
+/*! \brief turn an edge list into a simple undirected graph on all cores:
+           drop self-loops, store each edge once as (min, max), and drop
+           repeated copies, whichever direction they were given in. The
+           edges are radix sorted by (min, max) on the way, and a line
+           reporting what was removed is printed.
+
+    \param edgeArray the edges to simplify, in place. They are left sorted.
+
+    \return what was removed.
+*/
+
+SimplifyStats simplifyEdgeArray(EdgeArray* edgeArray)
+{
+    SimplifyStats stats;
+    long numEdges = edgeArray->numEdges;
+    int numThreads = numLoaderThreads(numEdges*sizeof(uint64_t));
+    SimplifyBlock* blocks = (SimplifyBlock *)Calloc(numThreads, sizeof(SimplifyBlock));
+    int i = 0;
+
+    for (i = 0; i < numThreads; i++)
+        blocks[i].edgeArray = edgeArray;
+
+    // count the edges that are not self-loops, then write their keys
+    splitBlocks(blocks, numThreads, numEdges);
+    long numKeys = runSimplifyPhase(blocks, numThreads, SIMPLIFY_COUNT_KEYS);
+
+    uint64_t* keys = (uint64_t *)Malloc(numKeys*sizeof(uint64_t));
+    uint64_t* buffer = (uint64_t *)Malloc(numKeys*sizeof(uint64_t));
+
+    for (i = 0; i < numThreads; i++)
+    {
+        blocks[i].keys = keys;
+        blocks[i].numKeys = numKeys;
+    }
+
+    runSimplifyPhase(blocks, numThreads, SIMPLIFY_WRITE_KEYS);
+
+    // least significant digit radix sort, skipping the digits that are
+    // zero in every key: max << 1 | dir needs bitsFor(2n) bits, min
+    // needs bitsFor(n) bits starting at bit 32
+    int lowBits = bitsFor(2*(uint64_t)edgeArray->n);
+    int highBits = bitsFor((uint64_t)edgeArray->n);
+    long (*buckets)[RADIX_BUCKETS] = (long (*)[RADIX_BUCKETS])Malloc(numThreads*sizeof(*buckets));
+    int shift = 0;
+
+    splitBlocks(blocks, numThreads, numKeys);
+    for (i = 0; i < numThreads; i++)
+        blocks[i].bucket = buckets[i];
+
+    for (shift = 0; shift < 32 + highBits; shift += RADIX_BITS)
+    {
+        if (shift >= lowBits && shift < 32)
+        {
+            shift = 32 - RADIX_BITS;
+            continue;
+        }
+
+        for (i = 0; i < numThreads; i++)
+        {
+            blocks[i].keys = keys;
+            blocks[i].buffer = buffer;
+            blocks[i].shift = shift;
+        }
+
+        runSimplifyPhase(blocks, numThreads, SIMPLIFY_HISTOGRAM);
+
+        // turn the per-block digit counts into scatter positions, so that
+        // keys with equal digits keep their order across blocks
+        long position = 0;
+        int digit = 0;
+        for (digit = 0; digit < RADIX_BUCKETS; digit++)
+        {
+            for (i = 0; i < numThreads; i++)
+            {
+                long count = buckets[i][digit];
+                buckets[i][digit] = position;
+                position += count;
+            }
+        }
+
+        runSimplifyPhase(blocks, numThreads, SIMPLIFY_SCATTER);
+
+        uint64_t* swap = keys;
+        keys = buffer;
+        buffer = swap;
+    }
+
+    for (i = 0; i < numThreads; i++)
+        blocks[i].keys = keys;
+
+    // keep the first copy of each edge
+    runSimplifyPhase(blocks, numThreads, SIMPLIFY_COUNT_GROUPS);
+
+    stats.numInput = numEdges;
+    stats.numSelfLoops = numEdges - numKeys;
+    stats.numBothDirections = 0;
+    for (i = 0; i < numThreads; i++)
+        stats.numBothDirections += blocks[i].numBothDirections;
+
+    edgeArray->numEdges = runSimplifyPhase(blocks, numThreads, SIMPLIFY_WRITE_GROUPS);
+    stats.numDuplicates = numKeys - edgeArray->numEdges;
+
+    Free(buckets);
+    Free(buffer);
+    Free(keys);
+    Free(blocks);
+
+    printf("Read %ld edges: removed %ld self-loops and %ld repeated edges (%ld edges were given in both directions), kept %ld.\n",
+           stats.numInput, stats.numSelfLoops, stats.numDuplicates, stats.numBothDirections, edgeArray->numEdges);
+
+    return stats;
+}
+
+/*! \brief one phase of csrFromEdgeArray on one block of edges; run as
+           a thread.
+
+    \param arg the FillBlock to process.
+*/
+
+static void* fillBlock(void* arg)
+{
+    FillBlock* block = (FillBlock*)arg;
+    int* edges = block->edgeArray->edges;
+    CSRGraph* graph = block->graph;
+    long i = 0;
+
+    for (i = block->begin; i < block->end; i++)
+    {
+        int u = edges[2*i];
+        int v = edges[2*i+1];
+
+        if (block->cursor == NULL)
+        {
+            // offsets[v+1] holds the degree of v until the prefix sum
+            __atomic_fetch_add(&graph->offsets[u+1], 1, __ATOMIC_RELAXED);
+            __atomic_fetch_add(&graph->offsets[v+1], 1, __ATOMIC_RELAXED);
+        }
+        else
+        {
+            graph->neighbors[__atomic_fetch_add(&block->cursor[u], 1, __ATOMIC_RELAXED)] = v;
+            graph->neighbors[__atomic_fetch_add(&block->cursor[v], 1, __ATOMIC_RELAXED)] = u;
+        }
+    }
+
+    return NULL;
+}
+
+/*! \brief build a CSRGraph from a simplified edge list on all cores,
+           adding each edge to the lists of both endpoints.
+
+    \param edgeArray edges as left by simplifyEdgeArray
+
+    \return a newly allocated CSRGraph, with every adjacency list sorted
+*/
+
+CSRGraph* csrFromEdgeArray(EdgeArray* edgeArray)
+{
+    CSRGraph* graph = (CSRGraph *)Calloc(1, sizeof(CSRGraph));
+    int n = edgeArray->n;
+    int numThreads = numLoaderThreads(edgeArray->numEdges*2*sizeof(int));
+    FillBlock* blocks = (FillBlock *)Calloc(numThreads, sizeof(FillBlock));
+    int i = 0;
+
+    graph->n = n;
+    graph->offsets = (long *)Calloc(n+1, sizeof(long));
+
+    for (i = 0; i < numThreads; i++)
+    {
+        blocks[i].edgeArray = edgeArray;
+        blocks[i].graph = graph;
+        blocks[i].begin = edgeArray->numEdges*i/numThreads;
+        blocks[i].end = edgeArray->numEdges*(i+1)/numThreads;
+    }
+
+    runThreads(fillBlock, blocks, sizeof(FillBlock), numThreads);
+
+    for (i = 0; i < n; i++)
+        graph->offsets[i+1] += graph->offsets[i];
+
+    graph->m = graph->offsets[n];
+    graph->neighbors = (int *)Malloc(graph->m*sizeof(int));
+
+    long* cursor = (long *)Malloc((n+1)*sizeof(long));
+    memcpy(cursor, graph->offsets, (n+1)*sizeof(long));
+
+    for (i = 0; i < numThreads; i++)
+        blocks[i].cursor = cursor;
+
+    runThreads(fillBlock, blocks, sizeof(FillBlock), numThreads);
+
+    Free(cursor);
+    Free(blocks);
+
+    // threads place edges in a nondeterministic order, so sort
+    // each list to make the graph independent of the thread count
+    if (numThreads > 1)
+        sortAdjacencyLists(graph);
+
+    return graph;
+}
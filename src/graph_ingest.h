@@ -0,0 +1,96 @@
+#ifndef _DJS_GRAPH_INGEST_H_
+#define _DJS_GRAPH_INGEST_H_
+
+/*
+    This file contains the algorithm for listing all cliques
+    according to the algorithm of Jain et al. specified in
+    "The power of pivoting for exact clique counting." (WSDM 2020).
+
+    This code is a modified version of the code of quick-cliques-1.0 library for counting
+    maximal cliques by Darren Strash (first name DOT last name AT gmail DOT com).
+
+    Original author: Darren Strash (first name DOT last name AT gmail DOT com)
+
+    Copyright (c) 2011 Darren Strash. This code is released under the GNU Public License (GPL) 3.0.
+
+    Modifications Copyright (c) 2020 Shweta Jain
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<stdint.h>
+
+#include"graph_io.h"
+
+#define FORMAT_EDGES 0 //!< "n m" header, then one "u v" line per edge, vertices 0..n-1
+#define FORMAT_SNAP 1 //!< SNAP edge lists: whitespace separated ids, '#' or '%' comments
+#define FORMAT_CSV 2 //!< comma separated "u,v" pairs, as read by readInGraphAdjList
+#define FORMAT_MTX 3 //!< MatrixMarket coordinate files, 1-based
+#define FORMAT_METIS 4 //!< METIS adjacency files, one line per vertex, 1-based
+
+#define IDMAP_SUFFIX ".idmap"
+#define SHARD_MANIFEST "manifest" //!< holds "n m" for a directory of headerless .edges shards
+
+/*! \struct TokenRef
+
+    \brief A vertex id as it appears in the input file, so that ids of
+           any length (64-bit integers, strings) can be compacted without
+           copying them.
+*/
+
+struct TokenRef
+{
+    uint64_t offset; //!< position of the id in the file
+    uint32_t length; //!< length of the id in bytes
+    uint32_t hash; //!< hash of the id's bytes
+};
+
+typedef struct TokenRef TokenRef;
+
+/*! \struct SimplifyStats
+
+    \brief What simplifyEdgeArray removed from an edge list.
+*/
+
+struct SimplifyStats
+{
+    long numInput; //!< the number of edges read
+    long numSelfLoops; //!< the number of self-loops removed
+    long numDuplicates; //!< the number of repeated edges removed, in either direction
+    long numBothDirections; //!< the number of edges given both as (u, v) and (v, u)
+};
+
+typedef struct SimplifyStats SimplifyStats;
+
+int parseGraphFormat(const char* name);
+
+int formatHasIdMap(int format);
+
+EdgeArray* ingestEdgeFiles(char** paths, int numPaths, int format, int n, const char* idMapPath);
+
+EdgeArray* ingestEdgeFile(char* fpath, int format, const char* idMapPath);
+
+int isShardedInput(const char* fpath);
+
+char** listShards(const char* fpath, int* numShards, char** directory, long* manifestN, long* manifestM);
+
+CSRGraph* loadShardedGraphCSR(char* fpath, int format);
+
+SimplifyStats simplifyEdgeArray(EdgeArray* edgeArray);
+
+CSRGraph* csrFromEdgeArray(EdgeArray* edgeArray);
+
+#endif
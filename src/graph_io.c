@@ -0,0 +1,906 @@
+/*
+    This file contains the algorithm for listing all cliques
+    according to the algorithm of Jain et al. specified in
+    "The power of pivoting for exact clique counting." (WSDM 2020).
+
+    This code is a modified version of the code of quick-cliques-1.0 library for counting
+    maximal cliques by Darren Strash (first name DOT last name AT gmail DOT com).
+
+    Original author: Darren Strash (first name DOT last name AT gmail DOT com)
+
+    Copyright (c) 2011 Darren Strash. This code is released under the GNU Public License (GPL) 3.0.
+
+    Modifications Copyright (c) 2020 Shweta Jain
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include<limits.h>
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<fcntl.h>
+#include<unistd.h>
+#include<pthread.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
+
+#include"misc.h"
+#include"MemoryManager.h"
+#include"graph_io.h"
+#include"graph_ingest.h"
+
+// below this many bytes per thread, splitting the file is not worth a thread
+#define MIN_BYTES_PER_THREAD (1 << 20)
+
+/*! \struct MappedEdgeFile
+
+    \brief A memory-mapped .edges file, with its header parsed.
+*/
+
+struct MappedEdgeFile
+{
+    int fd; //!< the open file
+    char* data; //!< the mapped file, NULL if it is empty
+    size_t size; //!< the size of the file in bytes
+    const char* body; //!< the first byte after the header
+    int n; //!< the number of vertices, from the header
+    long m; //!< the number of edges, from the header
+};
+
+typedef struct MappedEdgeFile MappedEdgeFile;
+
+/*! \struct ParseChunk
+
+    \brief A newline-aligned piece of an edge file, and the edges one
+           thread found in it.
+*/
+
+struct ParseChunk
+{
+    const char* begin; //!< first byte of the chunk
+    const char* end; //!< one past the last byte of the chunk
+    int n; //!< the number of vertices, to validate endpoints
+    int* edges; //!< parsed endpoints, two per edge
+    long numEdges; //!< the number of edges scanned
+    long capacity; //!< the number of edges edges has room for
+    int failed; //!< 1 if a malformed or invalid edge stopped the scan after numEdges edges
+};
+
+typedef struct ParseChunk ParseChunk;
+
+/*! \struct SortRange
+
+    \brief A range of vertices whose adjacency lists one thread sorts.
+*/
+
+struct SortRange
+{
+    CSRGraph* graph; //!< the graph being built
+    int begin; //!< first vertex of the range
+    int end; //!< one past the last vertex of the range
+};
+
+typedef struct SortRange SortRange;
+
+/*! \struct TaskPool
+
+    \brief A list of tasks that a few threads take turns to run.
+*/
+
+struct TaskPool
+{
+    void* (*function)(void*); //!< the function to run on each task
+    char* args; //!< the argument of each task
+    size_t argSize; //!< the size of one argument in bytes
+    int numTasks; //!< the number of tasks
+    int next; //!< the next task to hand out
+};
+
+typedef struct TaskPool TaskPool;
+
+/*! \brief choose the number of threads to parse a file of a given size.
+
+    \param bytes the number of bytes to parse
+
+    \return the number of online processors, capped so that each thread
+            gets at least MIN_BYTES_PER_THREAD bytes.
+*/
+
+int numLoaderThreads(size_t bytes)
+{
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    long bySize = (long)(bytes / MIN_BYTES_PER_THREAD) + 1;
+
+    if (processors < 1) processors = 1;
+
+    return (int)min(processors, bySize);
+}
+
+/*! \brief run a function on numThreads arguments concurrently, using
+           the calling thread for the first one.
+
+    \param function the function to run
+
+    \param args an array of numThreads arguments
+
+    \param argSize the size of one argument in bytes
+
+    \param numThreads the number of arguments
+*/
+
+void runThreads(void* (*function)(void*), void* args, size_t argSize, int numThreads)
+{
+    pthread_t* threads = (pthread_t *)Calloc(numThreads, sizeof(pthread_t));
+    int i = 0;
+
+    for (i = 1; i < numThreads; i++)
+        pthread_create(&threads[i], NULL, function, (char *)args + i*argSize);
+    function(args);
+    for (i = 1; i < numThreads; i++)
+        pthread_join(threads[i], NULL);
+
+    Free(threads);
+}
+
+/*! \brief run one task of a TaskPool after another, until none are
+           left; run as a thread.
+
+    \param arg a pointer to the shared TaskPool pointer.
+*/
+
+static void* runPooledTasks(void* arg)
+{
+    TaskPool* pool = *(TaskPool**)arg;
+    int task = 0;
+
+    while ((task = __atomic_fetch_add(&pool->next, 1, __ATOMIC_RELAXED)) < pool->numTasks)
+        pool->function(pool->args + task*pool->argSize);
+
+    return NULL;
+}
+
+/*! \brief run a function on numTasks arguments with numThreads threads,
+           each taking the next argument as soon as it is done with one.
+
+    \param function the function to run
+
+    \param args an array of numTasks arguments
+
+    \param argSize the size of one argument in bytes
+
+    \param numTasks the number of arguments
+
+    \param numThreads the number of threads, including the calling thread
+*/
+
+void runTasks(void* (*function)(void*), void* args, size_t argSize, int numTasks, int numThreads)
+{
+    TaskPool pool;
+    pool.function = function;
+    pool.args = (char *)args;
+    pool.argSize = argSize;
+    pool.numTasks = numTasks;
+    pool.next = 0;
+
+    numThreads = max(1, min(numThreads, numTasks));
+    TaskPool** pools = (TaskPool **)Calloc(numThreads, sizeof(TaskPool*));
+    int i = 0;
+
+    for (i = 0; i < numThreads; i++)
+        pools[i] = &pool;
+
+    runThreads(runPooledTasks, pools, sizeof(TaskPool*), numThreads);
+    Free(pools);
+}
+
+/*! \brief scan one decimal integer, skipping leading whitespace.
+
+    \param p a pointer to the scan position, advanced past the integer
+
+    \param end one past the last byte that may be scanned
+
+    \param value will contain the integer on success
+
+    \return 1 on success, 0 if only whitespace remained, -1 on a malformed token.
+*/
+
+static int scanLong(const char** p, const char* end, long* value)
+{
+    const char* s = *p;
+
+    while (s < end && (*s == ' ' || *s == '\n' || *s == '\t' || *s == '\r'))
+        s++;
+
+    if (s == end)
+    {
+        *p = s;
+        return 0;
+    }
+
+    int negative = 0;
+    if (*s == '-')
+    {
+        negative = 1;
+        s++;
+    }
+
+    if (s == end || *s < '0' || *s > '9')
+        return -1;
+
+    long result = 0;
+    while (s < end && *s >= '0' && *s <= '9')
+    {
+        if (result > (LONG_MAX - 9)/10) return -1;
+        result = result*10 + (*s - '0');
+        s++;
+    }
+
+    *value = negative ? -result : result;
+    *p = s;
+    return 1;
+}
+
+/*! \brief scan one decimal integer that fits in an int, skipping
+           leading whitespace.
+
+    \return as scanLong, and -1 if the integer does not fit in an int.
+*/
+
+static int scanInt(const char** p, const char* end, int* value)
+{
+    long result = 0;
+    int status = scanLong(p, end, &result);
+
+    if (status == 1)
+    {
+        if (result > INT_MAX || result < -INT_MAX) return -1;
+        *value = (int)result;
+    }
+
+    return status;
+}
+
+/*! \brief scan the "u v" pairs in a chunk into the chunk's own edge
+           array; run as a thread.
+
+    \param arg the ParseChunk to work on.
+*/
+
+static void* parseChunk(void* arg)
+{
+    ParseChunk* chunk = (ParseChunk*)arg;
+    const char* p = chunk->begin;
+    int u = 0, v = 0;
+
+    chunk->numEdges = 0;
+    chunk->failed = 0;
+
+    // a line is at least 4 bytes ("0 1\n"), so a chunk can hold up to
+    // bytes/4 edges; most lines are longer, so start at half that and
+    // let the array grow when a chunk is full of short lines
+    chunk->capacity = (chunk->end - chunk->begin)/8 + 16;
+    chunk->edges = (int *)Malloc(2*chunk->capacity*sizeof(int));
+
+    while (1)
+    {
+        int status = scanInt(&p, chunk->end, &u);
+        if (status == 0) break;
+        if (status < 0 || scanInt(&p, chunk->end, &v) != 1)
+        {
+            chunk->failed = 1;
+            break;
+        }
+
+        // self-loops and repeated edges are removed later, by
+        // simplifyEdgeArray, but ids must name a vertex
+        if (u < 0 || u >= chunk->n || v < 0 || v >= chunk->n)
+        {
+            chunk->failed = 1;
+            break;
+        }
+
+        if (chunk->numEdges == chunk->capacity)
+        {
+            chunk->capacity *= 2;
+            chunk->edges = (int *)Realloc(chunk->edges, 2*chunk->capacity*sizeof(int));
+        }
+
+        chunk->edges[2*chunk->numEdges] = u;
+        chunk->edges[2*chunk->numEdges+1] = v;
+        chunk->numEdges++;
+    }
+
+    return NULL;
+}
+
+/*! \brief sort the adjacency lists of a range of vertices; run as a thread.
+
+    \param arg the SortRange to sort.
+*/
+
+static void* sortRange(void* arg)
+{
+    SortRange* range = (SortRange*)arg;
+    CSRGraph* graph = range->graph;
+    int v = 0;
+
+    for (v = range->begin; v < range->end; v++)
+        qsort(graph->neighbors + graph->offsets[v], graph->offsets[v+1] - graph->offsets[v],
+              sizeof(int), qsortComparator);
+
+    return NULL;
+}
+
+/*! \brief open and memory-map a .edges file and parse its "n m" header.
+           Exits the program if the file cannot be read or the header is
+           malformed.
+
+    \param fpath path to the input file
+
+    \param file will describe the mapped file when this function returns
+*/
+
+static void mapEdgeFile(char* fpath, MappedEdgeFile* file)
+{
+    file->fd = open(fpath, O_RDONLY);
+    if (file->fd < 0)
+    {
+        fprintf(stderr, "Could not open input file.\n");
+        exit(1);
+    }
+
+    struct stat fileStat;
+    if (fstat(file->fd, &fileStat) != 0)
+    {
+        fprintf(stderr, "Could not open input file.\n");
+        exit(1);
+    }
+
+    file->size = (size_t)fileStat.st_size;
+    file->data = NULL;
+
+    if (file->size > 0)
+    {
+        file->data = (char *)mmap(NULL, file->size, PROT_READ, MAP_PRIVATE, file->fd, 0);
+        if (file->data == MAP_FAILED)
+        {
+            fprintf(stderr, "Could not map input file.\n");
+            exit(1);
+        }
+        madvise(file->data, file->size, MADV_SEQUENTIAL);
+    }
+
+    const char* end = file->data + file->size;
+    file->body = file->data;
+    file->n = 0;
+    file->m = 0;
+
+    if (scanInt(&file->body, end, &file->n) != 1 || scanLong(&file->body, end, &file->m) != 1)
+    {
+        fprintf(stderr, "Number of vertices: %d\n", file->n);
+        fprintf(stderr, "Number of edges: %ld\n", file->m);
+        fprintf(stderr, "problem with line 1 in input file\n");
+        exit(1);
+    }
+}
+
+/*! \brief unmap and close a file opened with mapEdgeFile.
+
+    \param file the mapped file
+*/
+
+static void unmapEdgeFile(MappedEdgeFile* file)
+{
+    if (file->data != NULL) munmap(file->data, file->size);
+    close(file->fd);
+}
+
+/*! \brief split the body of a mapped file into one chunk per thread,
+           moving each boundary forward so that it falls just after a
+           newline.
+
+    \param file the mapped file
+
+    \param numThreads the number of chunks
+
+    \return a newly allocated array of numThreads chunks
+*/
+
+static ParseChunk* splitEdgeFile(MappedEdgeFile* file, int numThreads)
+{
+    ParseChunk* chunks = (ParseChunk *)Calloc(numThreads, sizeof(ParseChunk));
+    const char* end = file->data + file->size;
+    const char* chunkBegin = file->body;
+    int i = 0;
+
+    for (i = 0; i < numThreads; i++)
+    {
+        const char* chunkEnd = end;
+        if (i < numThreads - 1)
+        {
+            chunkEnd = file->body + (size_t)(end - file->body)*(i+1)/numThreads;
+            if (chunkEnd < chunkBegin) chunkEnd = chunkBegin;
+            while (chunkEnd < end && *chunkEnd != '\n') chunkEnd++;
+            if (chunkEnd < end) chunkEnd++;
+        }
+
+        chunks[i].begin = chunkBegin;
+        chunks[i].end = chunkEnd;
+        chunks[i].n = file->n;
+        chunkBegin = chunkEnd;
+    }
+
+    return chunks;
+}
+
+/*! \brief check that the chunks, in file order, hold at least m good
+           edges, and exit with the sequential reader's message if not.
+
+    \param chunks the chunks, after a scan
+
+    \param numThreads the number of chunks
+
+    \param m the number of edges the header promised
+*/
+
+static void checkEdgeCount(ParseChunk* chunks, int numThreads, long m)
+{
+    long numRead = 0;
+    int i = 0;
+
+    for (i = 0; i < numThreads && numRead < m; i++)
+    {
+        numRead += min(chunks[i].numEdges, m - numRead);
+
+        if (chunks[i].failed && numRead < m)
+            break;
+    }
+
+    if (numRead < m)
+    {
+        fprintf(stderr, "problem with line %ld in input file\n", numRead+2);
+        exit(1);
+    }
+}
+
+/*! \brief read a graph in .edges format ("n m" header followed by
+           one "u v" line per edge) by memory-mapping the file and
+           parsing newline-aligned chunks of it concurrently.
+
+    \param fpath path to the input file
+
+    \return the first m edges of the file, in file order. Exits the
+            program with the same messages as the sequential reader
+            if the header is malformed or fewer than m edges can be read.
+*/
+
+EdgeArray* readEdgeArrayParallel(char* fpath)
+{
+    MappedEdgeFile file;
+    mapEdgeFile(fpath, &file);
+
+    int numThreads = numLoaderThreads(file.data + file.size - file.body);
+    ParseChunk* chunks = splitEdgeFile(&file, numThreads);
+    int i = 0;
+
+    runThreads(parseChunk, chunks, sizeof(ParseChunk), numThreads);
+
+    checkEdgeCount(chunks, numThreads, file.m);
+
+    EdgeArray* edgeArray = (EdgeArray *)Malloc(sizeof(EdgeArray));
+    edgeArray->n = file.n;
+    edgeArray->numEdges = file.m;
+    edgeArray->edges = (int *)Malloc(2*file.m*sizeof(int));
+
+    // stitch the chunks together in file order, keeping
+    // only the first m edges like the sequential reader
+    long numRead = 0;
+    for (i = 0; i < numThreads && numRead < file.m; i++)
+    {
+        long take = min(chunks[i].numEdges, file.m - numRead);
+        memcpy(edgeArray->edges + 2*numRead, chunks[i].edges, 2*take*sizeof(int));
+        numRead += take;
+    }
+
+    for (i = 0; i < numThreads; i++)
+        Free(chunks[i].edges);
+
+    Free(chunks);
+    unmapEdgeFile(&file);
+
+    return edgeArray;
+}
+
+/*! \brief read a graph in .edges format into compressed sparse row
+           format, cleaning it on the way: the edges are parsed on all
+           cores, self-loops and repeated edges (in either direction) are
+           dropped by simplifyEdgeArray, and every remaining edge is placed
+           in the lists of both endpoints.
+
+    \param fpath path to the input file
+
+    \return the graph, with every adjacency list sorted. Exits the program
+            if the header is malformed, an endpoint is out of range, or
+            fewer than m edges can be read.
+*/
+
+CSRGraph* readGraphCSRParallel(char* fpath)
+{
+    EdgeArray* edgeArray = readEdgeArrayParallel(fpath);
+
+    simplifyEdgeArray(edgeArray);
+
+    CSRGraph* graph = csrFromEdgeArray(edgeArray);
+    destroyEdgeArray(edgeArray);
+
+    return graph;
+}
+
+/*! \brief sort every adjacency list of a graph on all cores, giving each
+           thread about the same number of neighbors.
+
+    \param graph the graph whose lists to sort
+*/
+
+void sortAdjacencyLists(CSRGraph* graph)
+{
+    int n = graph->n;
+    int numSortThreads = numLoaderThreads(graph->m*sizeof(int));
+    SortRange* ranges = (SortRange *)Calloc(numSortThreads, sizeof(SortRange));
+    int v = 0;
+    int i = 0;
+
+    for (i = 0; i < numSortThreads; i++)
+    {
+        ranges[i].graph = graph;
+        ranges[i].begin = v;
+
+        long target = graph->m*(i+1)/numSortThreads;
+        while (v < n && (graph->offsets[v] < target || i == numSortThreads - 1))
+            v++;
+        ranges[i].end = v;
+    }
+
+    runThreads(sortRange, ranges, sizeof(SortRange), numSortThreads);
+    Free(ranges);
+}
+
+/*! \brief free an EdgeArray and its edges.
+
+    \param edgeArray the EdgeArray to free
+*/
+
+void destroyEdgeArray(EdgeArray* edgeArray)
+{
+    Free(edgeArray->edges);
+    Free(edgeArray);
+}
+
+/*! \brief convert an adjacency list into compressed sparse row format,
+           preserving the order of every list.
+
+    \param adjList an array of linked lists of integers
+
+    \param n the number of vertices in the graph
+
+    \return a newly allocated CSRGraph
+*/
+
+CSRGraph* csrFromAdjList(LinkedList** adjList, int n)
+{
+    CSRGraph* graph = (CSRGraph *)Calloc(1, sizeof(CSRGraph));
+    graph->n = n;
+    graph->offsets = (long *)Calloc(n+1, sizeof(long));
+
+    int i = 0;
+    for (i = 0; i < n; i++)
+        graph->offsets[i+1] = graph->offsets[i] + length(adjList[i]);
+
+    graph->m = graph->offsets[n];
+    graph->neighbors = (int *)Malloc(graph->m*sizeof(int));
+
+    for (i = 0; i < n; i++)
+    {
+        long j = graph->offsets[i];
+        Link* curr = adjList[i]->head->next;
+        while (!isTail(curr))
+        {
+            graph->neighbors[j++] = curr->data;
+            curr = curr->next;
+        }
+    }
+
+    return graph;
+}
+
+/*! \brief fold a block of memory into a 64-bit FNV-1a style hash,
+           eight bytes at a time.
+
+    \param hash the running hash
+
+    \param data the bytes to hash
+
+    \param bytes the number of bytes to hash
+
+    \return the updated hash
+*/
+
+static uint64_t hashBytes(uint64_t hash, const void* data, size_t bytes)
+{
+    const unsigned char* p = (const unsigned char*)data;
+    size_t i = 0;
+
+    for (i = 0; i + 8 <= bytes; i += 8)
+    {
+        uint64_t word;
+        memcpy(&word, p + i, 8);
+        hash = (hash ^ word) * 1099511628211ULL;
+    }
+
+    for (; i < bytes; i++)
+        hash = (hash ^ p[i]) * 1099511628211ULL;
+
+    return hash;
+}
+
+/*! \brief compute the checksum stored in a CSR cache header.
+
+    \param graph a graph in compressed sparse row format
+
+    \return a hash of the offsets and neighbors arrays
+*/
+
+uint64_t csrChecksum(CSRGraph* graph)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    hash = hashBytes(hash, graph->offsets, (graph->n+1)*sizeof(long));
+    hash = hashBytes(hash, graph->neighbors, graph->m*sizeof(int));
+    return hash;
+}
+
+/*! \brief write a graph to a binary CSR cache file. The file is
+           written under a temporary name and renamed into place, so
+           a reader never sees a partial cache.
+
+    \param graph a graph in compressed sparse row format
+
+    \param cachePath the path of the cache file
+
+    \param sourceStat the stat of the text file the graph was read from
+
+    \param format the FORMAT_ constant the text file was parsed with
+
+    \return 1 on success, 0 if the cache could not be written.
+*/
+
+int writeCSRCache(CSRGraph* graph, const char* cachePath, struct stat* sourceStat, int format)
+{
+    CSRFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CSR_CACHE_MAGIC, 8);
+    header.version = CSR_CACHE_VERSION;
+    header.headerSize = sizeof(CSRFileHeader);
+    header.n = graph->n;
+    header.m = graph->m;
+    header.checksum = csrChecksum(graph);
+    header.sourceSize = (int64_t)sourceStat->st_size;
+    header.sourceMtime = (int64_t)sourceStat->st_mtime;
+    header.format = format;
+    header.compactedIds = formatHasIdMap(format);
+
+    char* tmpPath = (char *)Calloc(strlen(cachePath) + 5, sizeof(char));
+    strcpy(tmpPath, cachePath);
+    strcat(tmpPath, ".tmp");
+
+    FILE* fp = fopen(tmpPath, "wb");
+    if (!fp)
+    {
+        Free(tmpPath);
+        return 0;
+    }
+
+    int ok = (fwrite(&header, sizeof(header), 1, fp) == 1)
+          && (fwrite(graph->offsets, sizeof(long), graph->n+1, fp) == (size_t)graph->n+1)
+          && (fwrite(graph->neighbors, sizeof(int), graph->m, fp) == (size_t)graph->m);
+
+    ok = (fclose(fp) == 0) && ok;
+
+    if (ok) ok = (rename(tmpPath, cachePath) == 0);
+    if (!ok) unlink(tmpPath);
+
+    Free(tmpPath);
+    return ok;
+}
+
+/*! \brief map a binary CSR cache file and use it in place, without
+           parsing or copying.
+
+    \param cachePath the path of the cache file
+
+    \param sourceStat the stat of the text file the cache should have been
+                      built from, or NULL to accept the cache as is
+
+    \param format the FORMAT_ constant the text file is parsed with, or -1
+                  to accept a cache built with any format
+
+    \return the mapped graph, or NULL if the cache does not exist, is
+            from another version, does not match sourceStat or format, or
+            fails its size or checksum checks.
+*/
+
+CSRGraph* readCSRCache(const char* cachePath, struct stat* sourceStat, int format)
+{
+    int fd = open(cachePath, O_RDONLY);
+    if (fd < 0) return NULL;
+
+    struct stat cacheStat;
+    CSRFileHeader header;
+
+    if (fstat(fd, &cacheStat) != 0
+        || read(fd, &header, sizeof(header)) != (ssize_t)sizeof(header)
+        || memcmp(header.magic, CSR_CACHE_MAGIC, 8) != 0
+        || header.version != CSR_CACHE_VERSION
+        || header.headerSize != sizeof(CSRFileHeader)
+        || header.n < 0 || header.n > INT_MAX || header.m < 0)
+    {
+        close(fd);
+        return NULL;
+    }
+
+    if (sourceStat != NULL
+        && (header.sourceSize != (int64_t)sourceStat->st_size
+            || header.sourceMtime != (int64_t)sourceStat->st_mtime))
+    {
+        close(fd);
+        return NULL;
+    }
+
+    // a cache parsed with another format is another graph (and may lack the id map)
+    if (format >= 0
+        && (header.format != format
+            || header.compactedIds != (uint32_t)formatHasIdMap(format)))
+    {
+        close(fd);
+        return NULL;
+    }
+
+    size_t size = (size_t)cacheStat.st_size;
+    size_t expected = sizeof(CSRFileHeader) + (header.n+1)*sizeof(long) + header.m*sizeof(int);
+
+    if (size != expected)
+    {
+        close(fd);
+        return NULL;
+    }
+
+    void* mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (mapping == MAP_FAILED) return NULL;
+
+    CSRGraph* graph = (CSRGraph *)Calloc(1, sizeof(CSRGraph));
+    graph->n = (int)header.n;
+    graph->m = header.m;
+    graph->offsets = (long *)((char *)mapping + sizeof(CSRFileHeader));
+    graph->neighbors = (int *)(graph->offsets + graph->n + 1);
+    graph->mapping = mapping;
+    graph->mappingSize = size;
+
+    if (graph->offsets[0] != 0 || graph->offsets[graph->n] != graph->m
+        || csrChecksum(graph) != header.checksum)
+    {
+        destroyCSRGraph(graph);
+        return NULL;
+    }
+
+    return graph;
+}
+
+/*! \brief load a graph for counting. A binary CSR cache next to the
+           input (fpath + CSR_CACHE_SUFFIX) is used if it is current;
+           otherwise the text file is read and the cache is written for
+           the next run. fpath may also name a cache file directly, or a
+           directory or glob pattern of shards (see loadShardedGraphCSR).
+
+    \param fpath path to an input file, a CSR cache file, or shards
+
+    \param format one of the FORMAT_ constants. Graphs are simplified
+                  (no self-loops or duplicate edges) and,
+                  for SNAP and comma separated files, their ids are
+                  compacted and the original ids written to
+                  fpath + IDMAP_SUFFIX.
+
+    \return the graph in compressed sparse row format
+*/
+
+CSRGraph* loadGraphCSR(char* fpath, int format)
+{
+    if (isShardedInput(fpath))
+        return loadShardedGraphCSR(fpath, format);
+
+    struct stat sourceStat;
+    if (stat(fpath, &sourceStat) != 0)
+    {
+        fprintf(stderr, "Could not open input file.\n");
+        exit(1);
+    }
+
+    CSRGraph* graph = readCSRCache(fpath, NULL, -1);
+    if (graph != NULL) return graph;
+
+    char* cachePath = (char *)Calloc(strlen(fpath) + strlen(CSR_CACHE_SUFFIX) + 1, sizeof(char));
+    strcpy(cachePath, fpath);
+    strcat(cachePath, CSR_CACHE_SUFFIX);
+
+    graph = readCSRCache(cachePath, &sourceStat, format);
+    if (graph != NULL)
+    {
+        printf("Loaded graph from %s.\n", cachePath);
+        Free(cachePath);
+        return graph;
+    }
+
+    if (format == FORMAT_EDGES)
+    {
+        graph = readGraphCSRParallel(fpath);
+    }
+    else
+    {
+        char* idMapPath = NULL;
+        if (formatHasIdMap(format))
+        {
+            idMapPath = (char *)Calloc(strlen(fpath) + strlen(IDMAP_SUFFIX) + 1, sizeof(char));
+            strcpy(idMapPath, fpath);
+            strcat(idMapPath, IDMAP_SUFFIX);
+        }
+
+        EdgeArray* edgeArray = ingestEdgeFile(fpath, format, idMapPath);
+        simplifyEdgeArray(edgeArray);
+        graph = csrFromEdgeArray(edgeArray);
+        destroyEdgeArray(edgeArray);
+
+        if (idMapPath != NULL)
+        {
+            printf("Wrote original vertex ids to %s.\n", idMapPath);
+            Free(idMapPath);
+        }
+    }
+
+    if (!writeCSRCache(graph, cachePath, &sourceStat, format))
+        fprintf(stderr, "Could not write graph cache %s.\n", cachePath);
+
+    Free(cachePath);
+    return graph;
+}
+
+/*! \brief free a CSRGraph, unmapping its cache file if it has one.
+
+    \param graph the graph to free
+*/
+
+void destroyCSRGraph(CSRGraph* graph)
+{
+    if (graph->mapping != NULL)
+    {
+        munmap(graph->mapping, graph->mappingSize);
+    }
+    else
+    {
+        Free(graph->offsets);
+        Free(graph->neighbors);
+    }
+
+    Free(graph);
+}
@@ -0,0 +1,125 @@
+#ifndef _DJS_GRAPH_IO_H_
+#define _DJS_GRAPH_IO_H_
+
+/*
+    This file contains the algorithm for listing all cliques
+    according to the algorithm of Jain et al. specified in
+    "The power of pivoting for exact clique counting." (WSDM 2020).
+
+    This code is a modified version of the code of quick-cliques-1.0 library for counting
+    maximal cliques by Darren Strash (first name DOT last name AT gmail DOT com).
+
+    Original author: Darren Strash (first name DOT last name AT gmail DOT com)
+
+    Copyright (c) 2011 Darren Strash. This code is released under the GNU Public License (GPL) 3.0.
+
+    Modifications Copyright (c) 2020 Shweta Jain
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<stdint.h>
+#include<sys/stat.h>
+
+#include"LinkedList.h"
+
+#define CSR_CACHE_MAGIC "NCCLQCSR"
+#define CSR_CACHE_VERSION 2
+#define CSR_CACHE_SUFFIX ".csr"
+
+/*! \struct EdgeArray
+
+    \brief The edges of a graph, in input order, as a flat array of
+           endpoint pairs. Edge i is (edges[2*i], edges[2*i+1]).
+*/
+
+struct EdgeArray
+{
+    int n; //!< the number of vertices, from the header line
+    long numEdges; //!< the number of edges stored in edges
+    int* edges; //!< 2*numEdges endpoints, two per edge
+};
+
+typedef struct EdgeArray EdgeArray;
+
+/*! \struct CSRGraph
+
+    \brief An undirected graph in compressed sparse row format. Every edge
+           appears once in the adjacency list of each endpoint.
+*/
+
+struct CSRGraph
+{
+    int n; //!< the number of vertices
+    long m; //!< the number of entries in neighbors, 2x the number of edges
+    long* offsets; //!< the neighbors of v are neighbors[offsets[v]] to neighbors[offsets[v+1]-1]
+    int* neighbors; //!< all adjacency lists, concatenated
+    void* mapping; //!< the mapped cache file holding offsets and neighbors, or NULL if they were allocated
+    size_t mappingSize; //!< the size of mapping in bytes
+};
+
+typedef struct CSRGraph CSRGraph;
+
+/*! \struct CSRFileHeader
+
+    \brief The 64 byte header of a binary CSR cache file. It is followed by
+           n+1 64-bit offsets and m 32-bit neighbors, so that the file can be
+           mapped and used in place.
+*/
+
+struct CSRFileHeader
+{
+    char magic[8]; //!< CSR_CACHE_MAGIC
+    uint32_t version; //!< CSR_CACHE_VERSION
+    uint32_t headerSize; //!< sizeof(CSRFileHeader), where offsets begin
+    int64_t n; //!< the number of vertices
+    int64_t m; //!< the number of neighbors, 2x the number of edges
+    uint64_t checksum; //!< hash of the offsets and neighbors arrays
+    int64_t sourceSize; //!< size of the text file the cache was built from
+    int64_t sourceMtime; //!< modification time of the text file the cache was built from
+    int32_t format; //!< the FORMAT_ constant the text file was parsed with
+    uint32_t compactedIds; //!< 1 if the ids were compacted (and an id map written), 0 otherwise
+};
+
+typedef struct CSRFileHeader CSRFileHeader;
+
+int numLoaderThreads(size_t bytes);
+
+void runThreads(void* (*function)(void*), void* args, size_t argSize, int numThreads);
+
+void runTasks(void* (*function)(void*), void* args, size_t argSize, int numTasks, int numThreads);
+
+EdgeArray* readEdgeArrayParallel(char* fpath);
+
+CSRGraph* readGraphCSRParallel(char* fpath);
+
+void sortAdjacencyLists(CSRGraph* graph);
+
+void destroyEdgeArray(EdgeArray* edgeArray);
+
+CSRGraph* csrFromAdjList(LinkedList** adjList, int n);
+
+uint64_t csrChecksum(CSRGraph* graph);
+
+int writeCSRCache(CSRGraph* graph, const char* cachePath, struct stat* sourceStat, int format);
+
+CSRGraph* readCSRCache(const char* cachePath, struct stat* sourceStat, int format);
+
+CSRGraph* loadGraphCSR(char* fpath, int format);
+
+void destroyCSRGraph(CSRGraph* graph);
+
+#endif
@@ -32,39 +32,153 @@
 #include<sys/resource.h>
 #include<stdlib.h>
 #include<string.h>
+#include<math.h>
 
 
 #include"misc.h"
 #include"LinkedList.h"
 #include"MemoryManager.h"
 #include"degeneracy_helper.h"
+#include"twins.h"
+#include"graph_io.h"
+#include"graph_ingest.h"
 
 
-double nCr[1001][401];
+count_t** nCr = NULL; // nCr[n][r] is n choose r, for r <= n <= nCrMaxRow
+int nCrMaxRow = -1;
 
-void populate_nCr()
+/*! \brief build the table of binomial coefficients nCr[n][r] for
+           0 <= r <= n <= maxRow with Pascal's rule. Row n holds n+1
+           entries; all rows share one allocation.
+
+    \param maxRow the largest n needed. The recursion never drops more
+                  vertices than the degeneracy, so degeneracy + 1 is enough.
+*/
+
+void populate_nCr(int maxRow)
 {
-    FILE *infile;
-    infile = fopen("./src/nCr.txt","r");
-    double d=0;
-    if(infile==NULL)
+    destroy_nCr();
+
+    long numEntries = ((long)maxRow + 1)*((long)maxRow + 2)/2;
+    count_t* entries = (count_t *)Malloc(numEntries*sizeof(count_t));
+    nCr = (count_t **)Malloc(((long)maxRow + 1)*sizeof(count_t*));
+    nCrMaxRow = maxRow;
+
+    long offset = 0;
+    for (int row = 0; row <= maxRow; ++row)
     {
-        printf("file could not be opened\n");
-        exit(1);
+        nCr[row] = entries + offset;
+        offset += row + 1;
+
+        nCr[row][0] = 1;
+        nCr[row][row] = 1;
+        for (int col = 1; col < row; ++col)
+            nCr[row][col] = nCr[row-1][col-1] + nCr[row-1][col];
     }
+}
+
+/*! \brief free the table built by populate_nCr.
+*/
+
+void destroy_nCr()
+{
+    if (nCr == NULL) return;
+
+    Free(nCr[0]);
+    Free(nCr);
+    nCr = NULL;
+    nCrMaxRow = -1;
+}
+
+/*! \brief multiply out (1+x)^w - 1 over the classes kept by a leaf of the
+           recursion, on a graph of twin classes: a kept class contributes
+           any nonempty subset of its w vertices. Classes of weight 1
+           contribute x, a shift.
+
+    \param poly filled with the coefficients of degree 0 to max_k
+
+    \param keepV the kept vertices
+
+    \param keep the number of kept vertices
+
+    \param skipA an index into keepV to leave out of the product, or -1
+
+    \param skipB another index to leave out, or -1
+
+    \param weight the number of input vertices each vertex stands for
+
+    \param max_k the largest degree to keep
+
+    \return the lowest degree with a nonzero coefficient, the number of
+            classes in the product.
+*/
 
+int twinKeepPolynomial(count_t* poly, int* keepV, int keep, int skipA, int skipB, int* weight, int max_k)
+{
+    int shift = 0;
+    int top = 0;
+    int d = 0;
+
+    memset(poly, 0, (max_k + 1)*sizeof(count_t));
+    poly[0] = 1;
 
-    for(int row = 0; row < 1001; ++row)
+    for (int j = 0; j < keep; j++)
     {
-        for (int col = 0; col < 401; ++col)
+        if ((j == skipA) || (j == skipB)) continue;
+
+        int w = weight[keepV[j]];
+        if (w == 1)
+        {
+            shift++;
+            continue;
+        }
+
+        // in place from the top, since poly[d] only needs lower entries
+        int newTop = min(top + w, max_k);
+        for (d = newTop; d >= 0; d--)
         {
-            if (!fscanf(infile,"%lf,",&d)) 
-                fprintf(stderr, "Error\n");
-            // fprintf(stderr, "%lf\n", d);
-            nCr[row][col] = d;
+            count_t sum = 0;
+            for (int a = max(1, d - top); a <= min(w, d); a++)
+                sum += nCr[w][a]*poly[d-a];
+            poly[d] = sum;
         }
+        top = newTop;
+    }
+
+    if (shift > 0)
+    {
+        for (d = max_k; d >= 0; d--)
+            poly[d] = (d >= shift) ? poly[d-shift] : 0;
     }
-    fclose(infile);
+
+    return keep - (skipA >= 0) - (skipB >= 0);
+}
+
+/*! \brief the coefficient of x^t in poly(x) (1+x)^total: the number of
+           ways to pick t vertices, some counted by poly and the others
+           from total free ones.
+
+    \param poly coefficients, as filled by twinKeepPolynomial
+
+    \param lowest the lowest degree with a nonzero coefficient in poly
+
+    \param total the number of free vertices
+
+    \param t the degree wanted
+
+    \return the coefficient.
+*/
+
+count_t twinBinomialSum(count_t* poly, int lowest, int total, int t)
+{
+    count_t sum = 0;
+
+    if (total < 0) return 0;
+
+    for (int j = max(lowest, t - total); j <= t; j++)
+        sum += poly[j]*nCr[total][t-j];
+
+    return sum;
 }
 
 /*! \brief compare integers return -1,0,1 for <,=,>
@@ -283,89 +397,270 @@ LinkedList** readInGraphAdjList(int* n, int* m)
     return adjList;
 }
 
-/*! \brief read in a graph from stdin and return an 
-           adjacency list, as an array of linked lists
-           of integers.
+/*! \brief pack the later neighbors of an ordering with compressOrientedGraph
+           and print how much memory that saves.
 
-    \param n this will be the number of vertices in the
-             graph when this function returns.
+    \param orientedGraph the ordering to compress
 
-    \param m this will be 2x the number of edges in the
-             graph when this function returns.
+    \param m the number of edges
+*/
 
-    \return an array of linked lists of integers (adjacency list) 
-            representation of the graph
+static void compressOrientedGraphAndReport(OrientedGraph* orientedGraph, long m)
+{
+    clock_t start = clock();
+    long packedBytes = compressOrientedGraph(orientedGraph);
+    clock_t end = clock();
+
+    // the later and earlier arrays together hold every edge twice
+    printf("Compressed oriented adjacency to %ld bytes from %ld in %lf seconds.\n",
+           packedBytes, 2*m*(long)sizeof(int), (double)(end-start)/(double)(CLOCKS_PER_SEC));
+}
+
+/*! \brief put all vertices in a random order, with a fixed seed so that
+           every call and every run gives the same order.
+
+    \param shuffled an array of size n, filled with the vertices
+
+    \param n the number of vertices
 */
 
-LinkedList** readInGraphAdjListToDoubleEdges(int* n, int* m, char *fpath)
+void shuffleVertices(int* shuffled, int n)
 {
-    int u, v; // endvertices, to read edges.
+    unsigned long long seed = 0x9E3779B97F4A7C15ULL;
 
-    FILE *fp;
-    fp = fopen (fpath,"r");
-    if (!fp) 
+    for (int i = 0; i < n; i++)
+        shuffled[i] = i;
+    for (int i = n - 1; i > 0; i--)
     {
-        fprintf(stderr, "Could not open input file.\n");
-        exit(1);
+        seed = seed*6364136223846793005ULL + 1442695040888963407ULL;
+        int j = (int)((seed >> 33) % (unsigned long long)(i + 1));
+        int vertex = shuffled[j];
+        shuffled[j] = shuffled[i];
+        shuffled[i] = vertex;
     }
+}
+
+/*! \brief estimate the work of the whole recursion under an ordering. A
+           few roots with many later neighbors can dominate it, so the
+           roots with the most later neighbors are run in full and the
+           rest of the work is extrapolated from a uniform sample.
+
+    \param orientedGraph an ordering
+
+    \param n the number of vertices
 
-    if(fscanf(fp, "%d %d", n, m)!=2)
+    \param degeneracy the degeneracy of the graph, which bounds the depth
+                      of the recursion
+
+    \param max_k the largest clique size to count
+
+    \param shuffled all vertices in a random order, the same for every ordering
+
+    \param numRoots the number of roots to run, half of them the heaviest
+
+    \param budget give up without running any root if the cost is sure to
+                  be more than this, and stop running roots once it is;
+                  negative for no limit
+
+    \param skipped set to 1 if it gave up, 0 otherwise
+
+    \param sampledCost if not NULL, set to the cost of the roots that were
+                       actually run, before extrapolation
+
+    \param sampledSeconds if not NULL, set to the time the recursion from
+                          those roots took
+
+    \return the estimate, in the units of sampleRecursionCost_A, or a lower
+            bound above budget (or an estimate from the roots run so far)
+            if it gave up.
+*/
+
+double estimateRecursionCost(OrientedGraph* orientedGraph, int n, int degeneracy, int max_k,
+                             int* shuffled, int numRoots, double budget, int* skipped,
+                             double* sampledCost, double* sampledSeconds)
+{
+    int numHeavy = numRoots/2;
+    int deg = 0;
+    double lowerBound = 0;
+
+    // the first call from every root alone counts 1 + |P|^2
+    for (int i = 0; i < n; i++)
     {
-        fprintf(stderr, "Number of vertices: %d\n", *n);
-        fprintf(stderr, "Number of edges: %d\n", *m);
-        fprintf(stderr, "problem with line 1 in input file\n");
-        exit(1);
+        deg = max(deg, numLater(orientedGraph, i));
+        lowerBound += 1 + (double)numLater(orientedGraph, i)*numLater(orientedGraph, i);
     }
 
-    LinkedList** adjList = (LinkedList**)Calloc(*n, sizeof(LinkedList*));
+    *skipped = (budget >= 0) && (lowerBound > budget);
+    if (sampledCost != NULL) *sampledCost = 0;
+    if (sampledSeconds != NULL) *sampledSeconds = 0;
+    if (*skipped)
+        return lowerBound;
 
-    int i = 0;
-    while(i < *n)
+    // find the smallest later degree among the numHeavy heaviest roots
+    int* numWithDegree = (int *)Calloc(deg + 1, sizeof(int));
+    for (int i = 0; i < n; i++)
+        numWithDegree[numLater(orientedGraph, i)]++;
+
+    int threshold = deg;
+    int numAbove = 0;
+    while ((threshold > 0) && (numAbove + numWithDegree[threshold] < numHeavy))
     {
-        adjList[i] = createLinkedList();
-        i++;
+        numAbove += numWithDegree[threshold];
+        threshold--;
     }
 
-    i = 0;
-    // double maxv = 0;
-    while(i < *m)
+    int* heavy = (int *)Calloc(max(numHeavy, 1), sizeof(int));
+    char* isHeavy = (char *)Calloc(max(n, 1), sizeof(char));
+    int numAtThreshold = numHeavy - numAbove;
+    int h = 0;
+
+    for (int i = 0; (i < n) && (h < numHeavy); i++)
     {
-        if (fscanf(fp, "%d %d\n", &u, &v)!=2)
+        int laterDegree = numLater(orientedGraph, i);
+        if ((laterDegree > threshold) || ((laterDegree == threshold) && (numAtThreshold-- > 0)))
         {
-            printf("problem with line %d in input file, u=%d, v=%d\n", i+2, u, v);
-            exit(1);
+            heavy[h++] = i;
+            isHeavy[i] = 1;
         }
-        // if ((u>= *n) || (v >= *n)) printf("u = %d, v = %d \n", u, v);
-        // if ((double) u > maxv) maxv = (double) u;
-        // if ((double) v > maxv) maxv = (double) v;
-        assert(u < *n && u > -1);
-        assert(v < *n && v > -1);
-        assert(u != v);
+    }
 
-        addLast(adjList[u], (int)v);
-        addLast(adjList[v], (int)u);
-        
-        i++;
+    int numLight = numRoots - h;
+    int* light = (int *)Calloc(max(numLight, 1), sizeof(int));
+    int l = 0;
+
+    for (int i = 0; (i < n) && (l < numLight); i++)
+    {
+        if (!isHeavy[shuffled[i]])
+            light[l++] = shuffled[i];
     }
-    // printf("maxv = %lf \n", maxv);
-    *m = (*m) * 2;
 
-    fclose(fp);
-    return adjList;
+    double heavySeconds = 0;
+    double lightSeconds = 0;
+    // the sample stops once the cost it would report passes the budget
+    double heavyCost = sampleRecursionCost_A(orientedGraph, n, degeneracy, max_k, heavy, h, budget, &heavySeconds);
+    double lightBudget = -1;
+    if (budget >= 0)
+        lightBudget = max(budget - heavyCost, 0)*l/max(n - h, 1);
+    double lightCost = 0;
+    if ((l > 0) && ((budget < 0) || (heavyCost <= budget)))
+        lightCost = sampleRecursionCost_A(orientedGraph, n, degeneracy, max_k, light, l, lightBudget, &lightSeconds);
+    double cost = heavyCost;
+    if (l > 0)
+        cost += lightCost*(n - h)/l;
+    *skipped = (budget >= 0) && (cost > budget);
+
+    if (sampledCost != NULL) *sampledCost = heavyCost + lightCost;
+    if (sampledSeconds != NULL) *sampledSeconds = heavySeconds + lightSeconds;
+
+    Free(numWithDegree);
+    Free(heavy);
+    Free(isHeavy);
+    Free(light);
+
+    return cost;
+}
+
+/*! \brief try every vertex ordering on the same sample of roots and keep
+           the one whose recursion does the least work.
+
+    \param graph an input graph, in compressed sparse row format
+
+    \param max_k the largest clique size to count, or 0 for all
+
+    \param ordering filled with the vertices in the chosen order
+
+    \param position filled with the index of each vertex in ordering
+
+    \return the chosen ordering, one of the ORDER_ constants.
+*/
+
+static int chooseVertexOrderAndReport(CSRGraph* graph, int max_k, int* ordering, int* position)
+{
+    int n = graph->n;
+    int numRoots = min(n, AUTO_ORDER_SAMPLES);
+    int* shuffled = (int *)Calloc(max(n, 1), sizeof(int));
+    int* candidateOrdering = (int *)Calloc(max(n, 1), sizeof(int));
+    int* candidatePosition = (int *)Calloc(max(n, 1), sizeof(int));
+    int best = -1;
+    double bestCost = 0;
+    int degeneracy = computeDegeneracy(graph);
+
+    populate_nCr(degeneracy + 1);
+
+    // every candidate samples the same roots
+    shuffleVertices(shuffled, n);
+
+    for (int order = 0; order < NUM_VERTEX_ORDERS; order++)
+    {
+        computeVertexOrder(graph, order, candidateOrdering, candidatePosition);
+        OrientedGraph* orientedGraph = computeOrientedGraph(graph, candidateOrdering, candidatePosition, 0);
+
+        int deg = 0;
+        for (int i = 0; i < n; i++)
+            deg = max(deg, numLater(orientedGraph, i));
+
+        int skipped = 0;
+        double cost = estimateRecursionCost(orientedGraph, n, degeneracy, (max_k == 0) ? degeneracy + 1 : max_k,
+                                            shuffled, numRoots, (best == -1) ? -1 : bestCost, &skipped, NULL, NULL);
+
+        if (skipped)
+            printf("Ordering %s: max out-degree %d, estimated recursion cost at least %.0lf.\n", vertexOrderName(order), deg, cost);
+        else
+            printf("Ordering %s: max out-degree %d, estimated recursion cost %.0lf.\n", vertexOrderName(order), deg, cost);
+
+        if ((best == -1) || (cost < bestCost))
+        {
+            best = order;
+            bestCost = cost;
+            memcpy(ordering, candidateOrdering, n*sizeof(int));
+            memcpy(position, candidatePosition, n*sizeof(int));
+        }
+
+        destroyOrientedGraph(orientedGraph);
+    }
+
+    destroy_nCr();
+
+    printf("Chose the %s ordering, sampling %d roots.\n", vertexOrderName(best), numRoots);
+
+    Free(shuffled);
+    Free(candidateOrdering);
+    Free(candidatePosition);
+
+    return best;
+}
+
+/*! \brief the name of a vertex in the input graph.
+
+    \param name the input vertex of each vertex of a pruned graph, or NULL
+                if the graph was not pruned
+
+    \param vertex a vertex of the (pruned) graph
+
+    \return name[vertex], or vertex if name is NULL.
+*/
+
+static inline int inputVertex(int* name, int vertex)
+{
+    return (name == NULL) ? vertex : name[vertex];
 }
 
-void runAndPrintStatsCliques(  LinkedList** adjListLinked,
-                               int n, const char * gname, 
-                               char T, int max_k, int flag_d, int flag_o)
+void runAndPrintStatsCliques(  CSRGraph* graph, const char * gname, 
+                               char T, int min_k, int max_k, int flag_d, int flag_o, int flag_c, int flag_twins,
+                               int bitsetBits, double bitsetDensity,
+                               double epsilon, int order,
+                               const char* orderIn, const char* orderOut)
 {
+    int n = graph->n;
   //printf("In runAndPrint function.\n");
     fflush(stderr);
     int max_k_in = max_k;
 
     clock_t start = clock();
 
-    double totalCliques = 0;
-    int deg = 0, m = 0;
+    count_t totalCliques = 0;
+    int deg = 0;
+    long m = 0; // the number of edges, which may not fit in an int
     FILE *fp;
 
     //printf("Before if of flag_d.\n");
@@ -377,9 +672,9 @@ void runAndPrintStatsCliques(  LinkedList** adjListLinked,
 
         strcpy(fname, "results/");
         strcat(fname, gname);
-        char * s_max_k = (char *)Calloc(10,sizeof(char));
-        sprintf(s_max_k, "%d", max_k);
-        if (max_k > 0) {strcat(fname, "_"); strcat(fname, s_max_k);}
+        char s_max_k[32]; // "_from" and any int
+        if (max_k > 0) {snprintf(s_max_k, sizeof(s_max_k), "_%d", max_k); strcat(fname, s_max_k);}
+        if (min_k > 0) {snprintf(s_max_k, sizeof(s_max_k), "_from%d", min_k); strcat(fname, s_max_k);}
         if (T == 'A')
         {
             if (flag_d == 2) strcat(fname, "_A_stat.txt");
@@ -402,23 +697,138 @@ void runAndPrintStatsCliques(  LinkedList** adjListLinked,
     //printf("Before computeDegeneracy.\n");
     fflush(stdout);
 
-    NeighborListArray **orderingArray;
-    if (flag_o == 0) 
-        orderingArray = computeDegeneracyOrderArray(adjListLinked, n);
+    // a vertex in a k-clique has core number at least k-1, so for
+    // k >= min_k only the (min_k-1)-core can hold one
+    CSRGraph* prunedGraph = NULL;
+    int* prunedName = NULL;
+    if (min_k > 1)
+    {
+        prunedGraph = pruneToCore(graph, min_k - 1, &prunedName);
+        printf("Pruned to the %d-core: %d vertices of %d, %ld edges of %ld.\n",
+               min_k - 1, prunedGraph->n, graph->n, prunedGraph->m/2, graph->m/2);
+        graph = prunedGraph;
+        n = graph->n;
+    }
+
+    // from here on graph is the graph with one vertex per class of twins
+    CSRGraph* inputGraph = graph;
+    TwinClasses* twins = NULL;
+    if (flag_twins == 1)
+    {
+        twins = findTwinClasses(inputGraph);
+        if (twins->numClasses < inputGraph->n)
+        {
+            graph = collapseTwinClasses(inputGraph, twins);
+            n = graph->n;
+            printf("Collapsed twins: %d vertices into %d, %ld edges into %ld.\n",
+                   inputGraph->n, graph->n, inputGraph->m/2, graph->m/2);
+        }
+        else
+        {
+            printf("Collapsed twins: the graph has none.\n");
+            destroyTwinClasses(twins);
+            twins = NULL;
+        }
+    }
+
+    OrientedGraph* orientedGraph;
+    struct timespec orderStart, orderEnd;
+    int* ordering = (int *)Calloc(max(n, 1), sizeof(int));
+    int* position = (int *)Calloc(max(n, 1), sizeof(int));
+    int degeneracy = -1;
+    int loaded = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &orderStart);
+    if (orderIn != NULL)
+    {
+        loaded = readOrderFile(orderIn, graph, ordering, position, &order, &epsilon, &degeneracy);
+        if (loaded)
+            printf("Loaded the ordering from %s.\n", orderIn);
+        else
+            fprintf(stderr, "Could not use the ordering in %s: it is missing, damaged or was computed for a different graph. Computing it again.\n", orderIn);
+    }
+
+    if (loaded)
+        ;
+    else if (epsilon > 0)
+        computeApproxDegeneracyPeeling(graph, epsilon, ordering, position);
+    else if (order == ORDER_AUTO)
+        order = chooseVertexOrderAndReport(graph, max_k, ordering, position);
     else
-        orderingArray = computeDegeneracyOrderArrayVerticesSorted(adjListLinked, n);
+        computeVertexOrder(graph, order, ordering, position);
+
+    orientedGraph = computeOrientedGraph(graph, ordering, position, flag_o);
+    if (twins != NULL)
+        setOrientedGraphWeights(orientedGraph, twins->weight);
+    clock_gettime(CLOCK_MONOTONIC, &orderEnd);
 
     //printf("Before for. After computeDegeneracy.\n");
     fflush(stdout);
     //printf("Degeneracy ordering:\n");
     for (int i=0; i<n; i++)
     {   
-        //printf("%d ", orderingArray[i]->vertex);
-        if (deg < orderingArray[i]->laterDegree) deg = orderingArray[i]->laterDegree;
-        m += orderingArray[i]->laterDegree;
+        if (deg < numLater(orientedGraph, i)) deg = numLater(orientedGraph, i);
+    }
+    m = orientedGraph->m;
+
+    // no clique has more than degeneracy + 1 vertices, whatever the
+    // ordering, so the binomial table and the counts stop there even
+    // when some vertex has more later neighbors
+    if (degeneracy < 0)
+    {
+        degeneracy = deg;
+        if ((epsilon > 0) || (order != ORDER_DEGENERACY))
+            degeneracy = computeDegeneracy(graph);
+    }
+
+    if (orderOut != NULL)
+    {
+        if (writeOrderFile(orderOut, graph, position, order, epsilon, degeneracy))
+            printf("Wrote the ordering to %s.\n", orderOut);
+        else
+            fprintf(stderr, "Could not write the ordering to %s.\n", orderOut);
     }
 
-    if (max_k == 0) max_k = deg + 1;
+    Free(ordering);
+    Free(position);
+
+    if (epsilon > 0)
+    {
+        printf("Approximate degeneracy ordering (epsilon = %lf) in %lf seconds: max out-degree %d, degeneracy %d.\n",
+               epsilon, (double)(orderEnd.tv_sec - orderStart.tv_sec) + 1e-9*(orderEnd.tv_nsec - orderStart.tv_nsec),
+               deg, degeneracy);
+        if ((flag_d == 1) || (flag_d == 2))
+            fprintf(fp, "approximate ordering epsilon,max out-degree,degen\n%lf,%d,%d\n\n", epsilon, deg, degeneracy);
+    }
+    else if (order != ORDER_DEGENERACY)
+    {
+        printf("Ordering %s: max out-degree %d, degeneracy %d.\n", vertexOrderName(order), deg, degeneracy);
+        if ((flag_d == 1) || (flag_d == 2))
+            fprintf(fp, "ordering,max out-degree,degen\n%s,%d,%d\n\n", vertexOrderName(order), deg, degeneracy);
+    }
+
+    // a class of twins stands for several input vertices, so the input
+    // graph bounds the clique size, not the collapsed one
+    if (twins != NULL)
+        degeneracy = computeDegeneracy(inputGraph);
+
+    if (max_k == 0) max_k = degeneracy + 1;
+    if (max_k < min_k) max_k = min_k;
+
+    // the counts hold sizes min_k to max_k only
+    long numK = max_k - min_k + 1;
+
+    populate_nCr(degeneracy + 1);
+    if (isinf(nCr[degeneracy + 1][(degeneracy + 1)/2]))
+        fprintf(stderr, "Warning: with degeneracy %d some counts exceed the range of the count type and will print as inf. Rebuild with make DEFINE=-DEXTENDED_COUNTS.\n", degeneracy);
+
+    // E mode builds its edge index from the later arrays first
+    if ((flag_c == 1) && (T != 'E'))
+        compressOrientedGraphAndReport(orientedGraph, m);
+
+#ifdef MEMORY_DEBUG
+    long allocationsBefore = numAllocations;
+#endif
 
     if (T == 'A')
     {
@@ -427,8 +837,8 @@ void runAndPrintStatsCliques(  LinkedList** adjListLinked,
         double *sumP = (double *)Calloc(1, sizeof(double));
         double *sqP = (double *)Calloc(1, sizeof(double));
 
-        double *cliqueCounts = (double *) Calloc((max_k)+1, sizeof(double));
-        listAllCliquesDegeneracy_A(cliqueCounts, orderingArray, n, max_k, nCalls, sumP, sqP,flag_o);
+        count_t *cliqueCounts = (count_t *) Calloc(numK, sizeof(count_t));
+        listAllCliquesDegeneracy_A(cliqueCounts, orientedGraph, n, degeneracy, min_k, max_k, nCalls, sumP, sqP, bitsetBits, bitsetDensity);
         clock_t end = clock();
        
         printf("time,nCalls,sumP,sqP,max_k,degen\n");
@@ -441,28 +851,28 @@ void runAndPrintStatsCliques(  LinkedList** adjListLinked,
 
         if (flag_d == 1) fprintf(fp, "k, Ck\n");
 
-        for (int i=0; i<=max_k; i++)
+        for (int i=min_k; i<=max_k; i++)
         {
-            if (cliqueCounts[i] != 0) 
+            if (cliqueCounts[i - min_k] != 0) 
             {
-                printf("%d, %lf\n", i, cliqueCounts[i]); 
-                if (flag_d == 1) fprintf(fp, "%d, %lf\n", i, cliqueCounts[i]); 
-                totalCliques += cliqueCounts[i];
+                printf("%d, %" PRIcount "\n", i, cliqueCounts[i - min_k]); 
+                if (flag_d == 1) fprintf(fp, "%d, %" PRIcount "\n", i, cliqueCounts[i - min_k]); 
+                totalCliques += cliqueCounts[i - min_k];
             }
         }
 
-        printf("\n%lf total cliques\n", totalCliques);
-        if (flag_d == 1) fprintf(fp, "\n%lf total cliques\n", totalCliques);
+        printf("\n%" PRIcount " total cliques\n", totalCliques);
+        if (flag_d == 1) fprintf(fp, "\n%" PRIcount " total cliques\n", totalCliques);
 
         Free(cliqueCounts);
     }
     else if (T == 'V')
     {
-        double *cliqueCounts = (double *) Calloc(n*((max_k)+1), sizeof(double));
-        listAllCliquesDegeneracy_V(cliqueCounts, orderingArray, n, max_k);
+        count_t *cliqueCounts = (count_t *) Calloc(max((long)n*numK, 1), sizeof(count_t));
+        listAllCliquesDegeneracy_V(cliqueCounts, orientedGraph, n, degeneracy, min_k, max_k, bitsetBits, bitsetDensity);
         clock_t end = clock();
 
-        double kcliques = 0;
+        count_t kcliques = 0;
 
         printf("time,max_k,degen\n");
         printf("%lf,%d,%d\n\n", (double)(end-start)/(double)(CLOCKS_PER_SEC),max_k_in, deg);
@@ -474,55 +884,62 @@ void runAndPrintStatsCliques(  LinkedList** adjListLinked,
 
         if (flag_d == 1) fprintf(fp, "(v,k): Ck\n");
 
-        for (int j=1; j<=max_k; j++)
+        for (int j=max(1, min_k); j<=max_k; j++)
         {
             kcliques = 0;
             for (int i=0; i<n; i++)
             {
-                kcliques += cliqueCounts[(i*(max_k+1)) + j];
-                if ((cliqueCounts[(i*(max_k+1)) + j] != 0) && (flag_d == 1))fprintf(fp,"(%d, %d): %.0lf\n", i, j, cliqueCounts[(i*(max_k+1)) + j]); 
+                long in = (long)i*numK + j - min_k;
+                int v = originalVertex(orientedGraph, i);
+                kcliques += twinWeight(twins, v)*cliqueCounts[in];
+                if ((cliqueCounts[in] != 0) && (flag_d == 1))
+                {
+                    for (int t=0; t<twinWeight(twins, v); t++)
+                        fprintf(fp,"(%d, %d): %.0" PRIcount "\n", inputVertex(prunedName, twinMember(twins, v, t)), j, cliqueCounts[in]); 
+                }
             }
 
             if (kcliques != 0)
             {
-                printf("%d, %lf\n", j, (double) (kcliques)/(double)(j)); totalCliques += ((double)(kcliques)/(double)(j));
+                printf("%d, %" PRIcount "\n", j, kcliques/j); totalCliques += kcliques/j;
             }
         }
-        if (flag_d == 1) fprintf(fp,"\n%lf total cliques\n", totalCliques);
+        if (flag_d == 1) fprintf(fp,"\n%" PRIcount " total cliques\n", totalCliques);
 
-        printf("\n%lf total cliques\n", totalCliques);
+        printf("\n%" PRIcount " total cliques\n", totalCliques);
         
         Free(cliqueCounts);
     }
     else if (T == 'E')
     {
         int* ordering = (int *)Calloc(n, sizeof(int));
-        int* CSCindex = (int *)Calloc(n+1, sizeof(int));
+        long* CSCindex = (long *)Calloc(n+1, sizeof(long));
         int* CSCedges = (int *)Calloc(m, sizeof(int));
 
-        double *cliqueCounts = (double *)Calloc(m*(max_k+1), sizeof(double));
+        count_t *cliqueCounts = (count_t *)Calloc(max(m*numK, 1), sizeof(count_t));
+        count_t *withinCounts = NULL;
+        if (twins != NULL)
+            withinCounts = (count_t *)Calloc((long)n*numK, sizeof(count_t));
 
-        int index = 0;
         int degen = deg;
 
+        // the later lists, each sorted, index the edges
+        memcpy(ordering, orientedGraph->orderNumber, n*sizeof(int));
+        memcpy(CSCindex, orientedGraph->laterOffsets, (n+1)*sizeof(long));
+        memcpy(CSCedges, orientedGraph->later, m*sizeof(int));
+
         for (int i=0; i<n; i++)
-        {
-            ordering[orderingArray[i]->vertex] = (int)orderingArray[i]->orderNumber;
-            deg = orderingArray[i]->laterDegree;
-            CSCindex[i] = index;
-            memcpy(CSCedges+index, orderingArray[i]->later, (deg)*sizeof(int));
-            qsort(CSCedges+index, deg, sizeof(int), qsortComparator);
-            index += deg;   
-        }
+            qsort(CSCedges+CSCindex[i], numLater(orientedGraph, i), sizeof(int), qsortComparator);
 
-        CSCindex[n] = m;
+        if (flag_c == 1)
+            compressOrientedGraphAndReport(orientedGraph, m);
 
         listAllCliquesDegeneracy_E(cliqueCounts, 
-                                    orderingArray,
+                                    orientedGraph,
                                     ordering,
                                     CSCindex,
                                     CSCedges,
-                                    n, max_k);
+                                    n, degeneracy, min_k, max_k, withinCounts, bitsetBits, bitsetDensity);
 
         clock_t end = clock();
 
@@ -535,44 +952,355 @@ void runAndPrintStatsCliques(  LinkedList** adjListLinked,
         }
     
         if (flag_d == 1) fprintf(fp, "(u,v,k): Ck\n");
-        double *kcliques = (double *)Calloc(max_k+1, sizeof(double));
+        count_t *kcliques = (count_t *)Calloc(max_k+1, sizeof(count_t));
 
         for (long i=0; i<n; i++)
         {
+            int u = originalVertex(orientedGraph, i);
             for (long j=CSCindex[i]; j<CSCindex[i+1]; j++)
             {
-                for (long k=2; k<=max_k; k++)
+                int v = originalVertex(orientedGraph, CSCedges[j]);
+                for (long k=max(2, min_k); k<=max_k; k++)
                 {
-                    if (cliqueCounts[((j*(max_k+1)) + k)] != 0) 
+                    count_t count = cliqueCounts[j*numK + k - min_k];
+                    if (count != 0) 
                     {
-                        kcliques[k] += cliqueCounts[((j*(max_k+1)) + k)];
-                        if (flag_d == 1) fprintf (fp, "(%d, %d, %d): %.0lf\n", i, CSCedges[j], k, cliqueCounts[((j*(max_k+1)) + k)]);
+                        // an edge between two classes of twins stands for
+                        // every edge between their vertices
+                        kcliques[k] += (count_t)twinWeight(twins, u)*twinWeight(twins, v)*count;
+                        if (flag_d == 1)
+                        {
+                            for (int a=0; a<twinWeight(twins, u); a++)
+                                for (int b=0; b<twinWeight(twins, v); b++)
+                                    fprintf (fp, "(%d, %d, %ld): %.0" PRIcount "\n", inputVertex(prunedName, twinMember(twins, u, a)), inputVertex(prunedName, twinMember(twins, v, b)), k, count);
+                        }
                     }
                 }
             }
+
+            // and the edges inside a class
+            if (twins == NULL) continue;
+            for (long k=max(2, min_k); k<=max_k; k++)
+            {
+                count_t within = withinCounts[i*numK + k - min_k];
+                int w = twinWeight(twins, u);
+                if (within == 0) continue;
+
+                kcliques[k] += (count_t)w*(w-1)/2*within;
+                if (flag_d == 1)
+                {
+                    for (int a=0; a<w; a++)
+                        for (int b=a+1; b<w; b++)
+                            fprintf (fp, "(%d, %d, %ld): %.0" PRIcount "\n", inputVertex(prunedName, twinMember(twins, u, a)), inputVertex(prunedName, twinMember(twins, u, b)), k, within);
+                }
+            }
         }
 
-        for (int k=2; k<=max_k; k++)
+        for (int k=max(2, min_k); k<=max_k; k++)
         {
             if (kcliques[k] != 0) 
             {
-                printf("%d, %lf\n", k, 2*kcliques[k]/((double)k*((double)k-1))); 
-                totalCliques += 2*kcliques[k]/((double)k*((double)k-1));
+                printf("%d, %" PRIcount "\n", k, 2*kcliques[k]/((count_t)k*((count_t)k-1))); 
+                totalCliques += 2*kcliques[k]/((count_t)k*((count_t)k-1));
             }
         }
         
-        printf("\n%lf total cliques\n", totalCliques);
-        if (flag_d == 1) fprintf(fp,"\n%lf total cliques\n", totalCliques);
+        printf("\n%" PRIcount " total cliques\n", totalCliques);
+        if (flag_d == 1) fprintf(fp,"\n%" PRIcount " total cliques\n", totalCliques);
 
         Free(ordering);
         Free(CSCindex);
         Free(CSCedges);
         Free(kcliques);
+        Free(withinCounts);
     }
 
+#ifdef MEMORY_DEBUG
+    printf("Counting made %ld allocations.\n", numAllocations - allocationsBefore);
+#endif
+
     if (flag_d >= 1) fclose(fp);
-    Free(orderingArray);
+    destroyOrientedGraph(orientedGraph);
+    destroy_nCr();
+
+    if (twins != NULL)
+    {
+        destroyTwinClasses(twins);
+        destroyCSRGraph(graph);
+    }
+
+    if (prunedGraph != NULL)
+    {
+        destroyCSRGraph(prunedGraph);
+        Free(prunedName);
+    }
+
+}
+
+/*! \brief allocate the candidate stack for one run of the recursion.
+           The candidates of a call are at most its P, which is at most the
+           largest out-degree d. Every call on a path from the root adds a
+           vertex to R, which stays a clique, so a path holds at most
+           degeneracy + 1 calls and the arrays on it at most
+           d*(degeneracy + 2) ints. (P also shrinks on the way down, so
+           d + (d-1) + ... + 1 is a bound too; the smaller one is used.)
+           The space is not touched until it is used, so the pages beyond
+           the deepest path actually reached are never mapped in.
+
+    \param maxOutDegree the largest number of later neighbors of a vertex
+                        in the ordering the recursion runs on
+
+    \param degeneracy the degeneracy of the graph, which bounds the depth
+                      of the recursion
+
+    \return the stack, empty.
+*/
+
+CandidateStack* createCandidateStack(int maxOutDegree, int degeneracy)
+{
+    long deg = maxOutDegree;
+
+    CandidateStack* stack = (CandidateStack *)Calloc(1, sizeof(CandidateStack));
+    stack->capacity = min(deg*(degeneracy + 2), deg*(deg + 1)/2) + 1;
+    stack->base = (int *)Malloc(stack->capacity*sizeof(int));
+    stack->top = 0;
+
+    return stack;
+}
+
+/*! \brief free the memory used by a candidate stack.
+
+    \param stack the stack
+*/
+
+void destroyCandidateStack(CandidateStack* stack)
+{
+    Free(stack->base);
+    Free(stack);
+}
+
+/*! \brief allocate the buffer for the neighborsInP lists of one run of
+           the recursion. It starts empty and grows with the largest root.
+
+    \return the arena.
+*/
+
+NeighborArena* createNeighborArena()
+{
+    return (NeighborArena *)Calloc(1, sizeof(NeighborArena));
+}
+
+/*! \brief free the memory used by a neighbor arena.
+
+    \param arena the arena
+*/
+
+void destroyNeighborArena(NeighborArena* arena)
+{
+    Free(arena->base);
+    Free(arena);
+}
+
+/*! \brief allocate the bit matrix for the bitset recursion of one run.
+
+    \param maxBits the largest P to move to bitsets: 64, 128 or 256, or 0
+                   to stay on the arrays
+
+    \param minDensity the smallest fraction of the possible edges a P must
+                      have to move to bitsets
+
+    \return the bit matrix, or NULL if maxBits is 0.
+*/
+
+BitsetGraph* createBitsetGraph(int maxBits, double minDensity)
+{
+    if (maxBits <= 0) return NULL;
+
+    BitsetGraph* bitset = (BitsetGraph *)Calloc(1, sizeof(BitsetGraph));
+    bitset->maxBits = min(maxBits, BITSET_MAX_BITS);
+    bitset->minDensity = minDensity;
+
+    return bitset;
+}
+
+/*! \brief allocate the state for a run of the pivot recursion, with every
+           vertex in the "other" part of vertexSets and no frames.
+
+    \param orientedGraph an ordering; twins are counted if it has weights
+
+    \param size the number of vertices in the graph
+
+    \param degeneracy the degeneracy of the graph, which bounds the depth
+                      of the recursion
+
+    \param cliqueCounts the counts the leaves add to
+
+    \param min_k the smallest clique size to count
+
+    \param max_k the largest clique size to count
+
+    \param bitsetBits the largest P to move to bitsets, or 0 to stay on arrays
+
+    \param bitsetDensity the smallest fraction of the possible edges a P must
+                         have to move to bitsets
+
+    \return the search. The E mode fields are left NULL.
+*/
+
+PivotSearch* createPivotSearch(OrientedGraph* orientedGraph, int size, int degeneracy, count_t* cliqueCounts,
+                               int min_k, int max_k, int bitsetBits, double bitsetDensity)
+{
+    PivotSearch* search = (PivotSearch *)Calloc(1, sizeof(PivotSearch));
+
+    // vertex sets are stored in an array like this:
+    // |--X--|--P--|--R--|
+    // and vertex i is stored in vertexSets[vertexLookup[i]]
+    search->vertexSets = (int *)Calloc(max(size, 1), sizeof(int));
+    search->vertexLookup = (int *)Calloc(max(size, 1), sizeof(int));
+    search->neighborsInP = (int **)Calloc(max(size, 1), sizeof(int*));
+    search->numNeighbors = (int *)Calloc(max(size, 1), sizeof(int));
+
+    int deg = 0;
+    for (int i = 0; i < size; i++)
+    {
+        search->vertexLookup[i] = i;
+        search->vertexSets[i] = i;
+        deg = max(deg, numLater(orientedGraph, i));
+    }
+
+    search->candidates = createCandidateStack(deg, degeneracy);
+    search->arena = createNeighborArena();
+    search->bitset = createBitsetGraph(bitsetBits, bitsetDensity);
+
+    // every frame has a smaller P than the one below it, and a clique
+    // holds a vertex and at most deg of its later neighbors
+    search->frames = (PivotFrame *)Calloc(deg + 2, sizeof(PivotFrame));
+    search->depth = 0;
+    search->keepV = (int *)Calloc(deg + 2, sizeof(int));
+    search->dropV = (int *)Calloc(deg + 2, sizeof(int));
+
+    search->cliqueCounts = cliqueCounts;
+    search->min_k = min_k;
+    search->max_k = max_k;
+
+    if (orientedGraph->weight != NULL)
+    {
+        search->twins = (TwinWeights *)Calloc(1, sizeof(TwinWeights));
+        search->twins->weight = orientedGraph->weight;
+        search->twins->keepPoly = (count_t *)Calloc(max_k + 1, sizeof(count_t));
+        search->twins->otherPoly = (count_t *)Calloc(max_k + 1, sizeof(count_t));
+    }
+
+    return search;
+}
+
+/*! \brief free the memory used by a pivot search, but not its counts.
+
+    \param search the search
+*/
+
+void destroyPivotSearch(PivotSearch* search)
+{
+    if (search->twins != NULL)
+    {
+        Free(search->twins->keepPoly);
+        Free(search->twins->otherPoly);
+        Free(search->twins);
+    }
+
+    Free(search->vertexSets);
+    Free(search->vertexLookup);
+    Free(search->neighborsInP);
+    Free(search->numNeighbors);
+    destroyCandidateStack(search->candidates);
+    destroyNeighborArena(search->arena);
+    Free(search->bitset);
+    Free(search->frames);
+    Free(search->keepV);
+    Free(search->dropV);
+    Free(search);
+}
+
+/*! \brief move a small P to bitsets: label its vertices 0 to |P|-1 in the
+           order of vertexSets and fill in their rows of the bit matrix.
+
+    \param bitset the bit matrix of the current run
+
+    \param vertexSets An array containing sets of vertices divided into sets X, P, R, and other.
+ 
+    \param vertexLookup A lookup table indexed by vertex number, storing the index of that 
+                        vertex in vertexSets.
+
+    \param neighborsInP Maps vertices to arrays of neighbors such that 
+                        neighbors in P fill the first cells
+
+    \param numNeighbors An upper bound on the number of neighbors in P of each vertex.
+
+    \param beginP The index where set P begins in vertexSets.
+
+    \param beginR The index where set R begins in vertexSets.
 
+    \param setP set to P, every label, if the function returns 1
+
+    \return 1 if P is small and dense enough and the recursion should go on
+            with bitsets, 0 if it should stay on the arrays.
+*/
+
+int fillInBitsetForRecursiveCall( BitsetGraph* bitset,
+                                  int* vertexSets, int* vertexLookup,
+                                  int** neighborsInP, int* numNeighbors,
+                                  int beginP, int beginR, uint64_t* setP )
+{
+    int sizeOfP = beginR - beginP;
+    if ((sizeOfP == 0) || (sizeOfP > bitset->maxBits)) return 0;
+
+    int numWords = (sizeOfP + 63)/64;
+    long degreeSum = 0;
+
+    for (int i = 0; i < sizeOfP; i++)
+    {
+        int vertex = vertexSets[beginP + i];
+        uint64_t* row = bitset->adjacency[i];
+        int numPotentialNeighbors = min(sizeOfP, numNeighbors[vertex]);
+
+        bitset->vertex[i] = vertex;
+        for (int w = 0; w < numWords; w++)
+            row[w] = 0;
+
+        for (int k = 0; k < numPotentialNeighbors; k++)
+        {
+            int neighborLocation = vertexLookup[neighborsInP[vertex][k]];
+            if ((neighborLocation < beginP) || (neighborLocation >= beginR)) break;
+
+            int label = neighborLocation - beginP;
+            row[label/64] |= 1ULL << (label%64);
+            degreeSum++;
+        }
+    }
+
+    if (degreeSum < bitset->minDensity*sizeOfP*(sizeOfP - 1)) return 0;
+
+    bitset->numWords = numWords;
+    for (int w = 0; w < numWords; w++)
+        setP[w] = ~0ULL;
+    if (sizeOfP % 64 != 0)
+        setP[numWords - 1] = (1ULL << (sizeOfP % 64)) - 1;
+
+    return 1;
+}
+
+/*! \brief the vertex of P with the most neighbors in P, on bitsets.
+
+    \param bitset the bit matrix of the current run
+
+    \param setP P, which is not empty
+
+    \return the label of the pivot; ties go to the smallest label.
+*/
+
+int findBestPivotBitset(BitsetGraph* bitset, const uint64_t* setP)
+{
+    return setKernels.bitsetBestPivot(&bitset->adjacency[0][0], BITSET_WORDS, setP, bitset->numWords);
 }
 
 /*! \brief Computes the vertex v in P union X that has the most neighbors in P,
@@ -582,6 +1310,8 @@ void runAndPrintStatsCliques(  LinkedList** adjListLinked,
 
     \param pivotNonNeighbors  An intially unallocated pointer, which will contain the set 
                               P \ {neighborhood of v} when this function completes.
+                              The array is taken from candidates; the caller gives
+                              it back with popCandidates.
 
     \param numNonNeighbors A pointer to a single integer, which has been preallocated,
                            which will contain the number of elements in pivotNonNeighbors.
@@ -604,12 +1334,15 @@ void runAndPrintStatsCliques(  LinkedList** adjListLinked,
 
     \param beginR The index where set R begins in vertexSets.
 
+    \param candidates The candidate stack of the current run.
+
 */
 
 int findBestPivotNonNeighborsDegeneracyCliques( int** pivotNonNeighbors, int* numNonNeighbors,
                                                 int* vertexSets, int* vertexLookup,
                                                 int** neighborsInP, int* numNeighbors,
-                                                int beginX, int beginP, int beginR)
+                                                int beginX, int beginP, int beginR,
+                                                CandidateStack* candidates)
 {
     int pivot = -1;
     int maxIntersectionSize = -1;
@@ -622,25 +1355,9 @@ int findBestPivotNonNeighborsDegeneracyCliques( int** pivotNonNeighbors, int* nu
         int vertex = vertexSets[j];
         int numPotentialNeighbors = min(beginR - beginP, numNeighbors[vertex]); //bug resolved by Shweta
 
-        int numNeighborsInP = 0;
-
-        int k = 0;
-        while(k<numPotentialNeighbors)
-        {
-            int neighbor = neighborsInP[vertex][k];
-            int neighborLocation = vertexLookup[neighbor];
-
-            if(neighborLocation >= beginP && neighborLocation < beginR)
-            {
-                numNeighborsInP++;
-            }
-            else
-            {
-                break;
-            }
-
-            k++;
-        }
+        // the neighbors in P come first, so count up to the first one that is not
+        int numNeighborsInP = setKernels.prefixInRange(neighborsInP[vertex], numPotentialNeighbors,
+                                                       vertexLookup, beginP, beginR);
 
         if(numNeighborsInP > maxIntersectionSize)
         {
@@ -660,30 +1377,21 @@ int findBestPivotNonNeighborsDegeneracyCliques( int** pivotNonNeighbors, int* nu
     // we initialize enough space for all of P; this is
     // slightly space inefficient, but it results in faster
     // computation of non-neighbors.
-    *pivotNonNeighbors = (int *)Calloc(beginR-beginP, sizeof(int));
+    *pivotNonNeighbors = pushCandidates(candidates, beginR-beginP);
     memcpy(*pivotNonNeighbors, &vertexSets[beginP], (beginR-beginP)*sizeof(int));
 
     // we will decrement numNonNeighbors as we find neighbors
     *numNonNeighbors = beginR-beginP;
 
     int numPivotNeighbors = min(beginR - beginP, numNeighbors[pivot]); //bug resolved by Shweta
+    numPivotNeighbors = setKernels.prefixInRange(neighborsInP[pivot], numPivotNeighbors,
+                                                 vertexLookup, beginP, beginR);
   
     // mark the neighbors of pivot that are in P.
     j = 0;
     while(j<numPivotNeighbors)
     {
-        int neighbor = neighborsInP[pivot][j];
-        int neighborLocation = vertexLookup[neighbor];
-
-        if(neighborLocation >= beginP && neighborLocation < beginR)
-        {
-            (*pivotNonNeighbors)[neighborLocation-beginP] = -1;
-        }
-        else
-        {
-            break;
-        }
-
+        (*pivotNonNeighbors)[vertexLookup[neighborsInP[pivot][j]]-beginP] = -1;
         j++;
     }
 
@@ -715,14 +1423,12 @@ int findBestPivotNonNeighborsDegeneracyCliques( int** pivotNonNeighbors, int* nu
 
     \param vertex The vertex to move to R.
 
-    \param orderNumber The position of vertex in the ordering.
-
     \param vertexSets An array containing sets of vertices divided into sets X, P, and other.
  
     \param vertexLookup A lookup table indexed by vertex number, storing the index of that 
                         vertex in vertexSets.
 
-    \param orderingArray A degeneracy order of the input graph.
+    \param orientedGraph A degeneracy order of the input graph.
 
     \param neighborsInP Maps vertices to arrays of neighbors such that 
                         neighbors in P fill the first cells
@@ -745,14 +1451,18 @@ int findBestPivotNonNeighborsDegeneracyCliques( int** pivotNonNeighbors, int* nu
 
     \param pNewBeginR After function, contains the new index where set R begins
                       in vertexSets after adding vertex to R.
+
+    \param arena The buffer the lists in neighborsInP are cut from. The lists
+                 of the previous root are overwritten.
 */
 
-void fillInPandXForRecursiveCallDegeneracyCliques( int vertex, int orderNumber,
+void fillInPandXForRecursiveCallDegeneracyCliques( int vertex,
                                                    int* vertexSets, int* vertexLookup, 
-                                                   NeighborListArray** orderingArray,
+                                                   OrientedGraph* orientedGraph,
                                                    int** neighborsInP, int* numNeighbors,
                                                    int* pBeginX, int *pBeginP, int *pBeginR, 
-                                                   int* pNewBeginX, int* pNewBeginP, int *pNewBeginR)
+                                                   int* pNewBeginX, int* pNewBeginP, int *pNewBeginR,
+                                                   NeighborArena* arena)
 {
     int vertexLocation = vertexLookup[vertex];
 
@@ -767,10 +1477,23 @@ void fillInPandXForRecursiveCallDegeneracyCliques( int vertex, int orderNumber,
 
     //printf("Before 1st while\n");
     // swap later neighbors of vertex into P section of vertexSets
+    // later neighbors are read from the packed list if the
+    // ordering was compressed, and from the later array otherwise
+    const unsigned char* packed = NULL;
+    const int* later = NULL;
+    if (orientedGraph->laterPacked != NULL)
+        packed = orientedGraph->laterPacked + orientedGraph->packedOffsets[vertex];
+    else
+        later = orientedGraph->later + orientedGraph->laterOffsets[vertex];
+    int degree = numLater(orientedGraph, vertex);
+    int neighbor = -1;
     int j = 0;
-    while(j<orderingArray[orderNumber]->laterDegree)
+    while(j<degree)
     {
-        int neighbor = orderingArray[orderNumber]->later[j];
+        if (packed != NULL)
+            neighbor = unpackNextNeighbor(&packed, neighbor);
+        else
+            neighbor = later[j];
         int neighborLocation = vertexLookup[neighbor];
 
         (*pNewBeginP)--;
@@ -785,22 +1508,37 @@ void fillInPandXForRecursiveCallDegeneracyCliques( int vertex, int orderNumber,
 
     *pNewBeginX = *pNewBeginP;
 
-    // reset numNeighbors and neighborsInP for this vertex
+    // reset numNeighbors and neighborsInP for this vertex, cutting
+    // the lists one after another from the start of the arena
+    long listsSize = 0;
+    j = *pNewBeginP;
+    while(j<*pNewBeginR)
+    {
+        int vertexInP = vertexSets[j];
+        listsSize += min( *pNewBeginR-*pNewBeginP, 
+                          numLater(orientedGraph, vertexInP) 
+                        + numEarlier(orientedGraph, vertexInP));
+        j++;
+    }
+
+    if (listsSize > arena->capacity)
+    {
+        Free(arena->base);
+        arena->capacity = max(listsSize, 2*arena->capacity);
+        arena->base = (int *)Malloc(arena->capacity*sizeof(int));
+    }
+
+    int* nextList = arena->base;
     j = *pNewBeginP;
     //printf("Before 2nd while\n");
     while(j<*pNewBeginR)
     {
         int vertexInP = vertexSets[j];
-        //printf("vertexInP = %d, numNeighbors[vertexInP]=%d\n", vertexInP, numNeighbors[vertexInP] );
-        //printf("Address being freed: %p\n", neighborsInP[vertexInP]);
         numNeighbors[vertexInP] = 0;
-        Free(neighborsInP[vertexInP]);
-        //printf("Allocating %d space for neighborsInP[vertexInP].\n", min( *pNewBeginR-*pNewBeginP, 
-                                           //  orderingArray[vertexInP]->laterDegree 
-                                           //+ orderingArray[vertexInP]->earlierDegree));
-        neighborsInP[vertexInP]= (int *)Calloc( min( *pNewBeginR-*pNewBeginP, 
-                                             orderingArray[vertexInP]->laterDegree 
-                                           + orderingArray[vertexInP]->earlierDegree), sizeof(int));
+        neighborsInP[vertexInP] = nextList;
+        nextList += min( *pNewBeginR-*pNewBeginP, 
+                         numLater(orientedGraph, vertexInP) 
+                       + numEarlier(orientedGraph, vertexInP));
 
         j++;
     }
@@ -813,10 +1551,19 @@ void fillInPandXForRecursiveCallDegeneracyCliques( int vertex, int orderNumber,
     {
         int vertexInP = vertexSets[j];
 
+        if (orientedGraph->laterPacked != NULL)
+            packed = orientedGraph->laterPacked + orientedGraph->packedOffsets[vertexInP];
+        else
+            later = orientedGraph->later + orientedGraph->laterOffsets[vertexInP];
+        int laterDegree = numLater(orientedGraph, vertexInP);
+        int laterNeighbor = -1;
         int k = 0;
-        while(k<orderingArray[vertexInP]->laterDegree)
+        while(k<laterDegree)
         {
-            int laterNeighbor = orderingArray[vertexInP]->later[k];
+            if (packed != NULL)
+                laterNeighbor = unpackNextNeighbor(&packed, laterNeighbor);
+            else
+                laterNeighbor = later[k];
             int laterNeighborLocation = vertexLookup[laterNeighbor];
 
             if(laterNeighborLocation >= *pNewBeginP && laterNeighborLocation < *pNewBeginR)
@@ -898,19 +1645,13 @@ void moveToRDegeneracyCliques( int vertex,
         int neighborLocation = j;
 
         int numPotentialNeighbors = min(sizeOfP, numNeighbors[neighbor]); 
-        int k = 0;
-        while(k<numPotentialNeighbors)
+        if(setKernels.listContains(neighborsInP[neighbor], numPotentialNeighbors, vertex))
         {
-            if(neighborsInP[neighbor][k] == vertex)
-            {
-                vertexSets[neighborLocation] = vertexSets[(*pNewBeginR)];
-                vertexLookup[vertexSets[(*pNewBeginR)]] = neighborLocation;
-                vertexSets[(*pNewBeginR)] = neighbor;
-                vertexLookup[neighbor] = (*pNewBeginR);
-                (*pNewBeginR)++;
-            }
-
-            k++;
+            vertexSets[neighborLocation] = vertexSets[(*pNewBeginR)];
+            vertexLookup[vertexSets[(*pNewBeginR)]] = neighborLocation;
+            vertexSets[(*pNewBeginR)] = neighbor;
+            vertexLookup[neighbor] = (*pNewBeginR);
+            (*pNewBeginR)++;
         }
 
         j++;
@@ -924,66 +1665,20 @@ void moveToRDegeneracyCliques( int vertex,
 
         int numPotentialNeighbors = min(sizeOfP, numNeighbors[thisVertex]); 
 
-        int numNeighborsInP = 0;
-
-        int k = 0;
-        while(k < numPotentialNeighbors)
-        {
-            int neighbor = neighborsInP[thisVertex][k];
-            int neighborLocation = vertexLookup[neighbor];
-            if(neighborLocation >= *pNewBeginP && neighborLocation < *pNewBeginR)
-            {
-                neighborsInP[thisVertex][k] = neighborsInP[thisVertex][numNeighborsInP];
-                neighborsInP[thisVertex][numNeighborsInP] = neighbor;
-                numNeighborsInP++;
-            }
-            k++;
-        }
+        // move the neighbors in the new P to the front of the list
+        setKernels.partitionInRange(neighborsInP[thisVertex], numPotentialNeighbors,
+                                    vertexLookup, *pNewBeginP, *pNewBeginR);
 
         j++;
     }
 }
 
-/*! \brief Move a vertex from the set R to the set X, and update all necessary pointers
-           and arrays of neighbors in P
-
-    \param vertex The vertex to move from R to X.
-
-    \param vertexSets An array containing sets of vertices divided into sets X, P, R, and other.
- 
-    \param vertexLookup A lookup table indexed by vertex number, storing the index of that 
-                        vertex in vertexSets.
-
-    \param pBeginX The index where set X begins in vertexSets.
- 
-    \param pBeginP The index where set P begins in vertexSets.
-
-    \param pBeginR The index where set R begins in vertexSets.
-
-*/
-
-void moveFromRToXDegeneracyCliques( int vertex, 
-                                    int* vertexSets, int* vertexLookup, 
-                                    int* pBeginX, int* pBeginP, int* pBeginR )
-{
-    int vertexLocation = vertexLookup[vertex];
-
-    //swap vertex into X and increment beginP and beginR
-    vertexSets[vertexLocation] = vertexSets[*pBeginP];
-    vertexLookup[vertexSets[*pBeginP]] = vertexLocation;
-    vertexSets[*pBeginP] = vertex;
-    vertexLookup[vertex] = *pBeginP;
-
-    *pBeginP = *pBeginP + 1;
-    *pBeginR = *pBeginR + 1;
-}
-
-int findNbrCSC(int u, int v, int *CSCindex, int *CSCedges)
+long findNbrCSC(int u, int v, long *CSCindex, int *CSCedges)
 {
-    int index = -1;
+    long index = -1;
 
-    int first = CSCindex[u], last = CSCindex[u+1] - 1;
-    int middle = (first+last)/2;
+    long first = CSCindex[u], last = CSCindex[u+1] - 1;
+    long middle = (first+last)/2;
 
     while (first <= last) 
     {
@@ -29,7 +29,163 @@
     along with this program.  If not, see <http://www.gnu.org/licenses/> 
 */
 
+#include<stdint.h>
+
+#include"set_kernels.h"
+
+// clique counts and binomial coefficients. A double overflows at about
+// 1e308 (C(1030, 515) already does); build with DEFINE=-DEXTENDED_COUNTS
+// to count in long double, which reaches about 1e4932, on graphs with a
+// higher degeneracy.
+#ifdef EXTENDED_COUNTS
+typedef long double count_t;
+#define PRIcount "Lf"
+#else
+typedef double count_t;
+#define PRIcount "lf"
+#endif
+
+/*! \struct TwinWeights
+
+    \brief What the engines need to count on a graph whose vertices stand
+           for classes of true twins (see twins.h). A leaf of the recursion
+           that keeps the vertices K and may drop the vertices D then stands
+           for the cliques that take a nonempty subset of every class in K
+           and any subset of every class in D.
+*/
+
+struct TwinWeights
+{
+    int* weight; //!< the number of input vertices each vertex stands for
+    count_t* keepPoly; //!< scratch for twinKeepPolynomial, max_k+1 entries
+    count_t* otherPoly; //!< more scratch of the same size
+    count_t* withinCounts; //!< E mode: per vertex and k, the count of each edge between two of its twins, or NULL
+};
+
+typedef struct TwinWeights TwinWeights;
+
+/*! \struct CandidateStack
+
+    \brief Scratch space for the arrays of candidates (P minus the
+           neighbors of the pivot) of the recursive calls. A call takes its
+           array from the top and gives it back before it returns, after
+           all of its children have given back theirs, so the arrays come
+           and go in LIFO order and the recursion never calls malloc.
+*/
+
+struct CandidateStack
+{
+    int* base; //!< the space, capacity ints
+    long capacity; //!< enough for every call on a path from the root
+    long top; //!< the first free int
+};
+
+typedef struct CandidateStack CandidateStack;
+
+/*! \struct NeighborArena
+
+    \brief One buffer for the lists of neighbors in P of the vertices in
+           the P of a root (neighborsInP). The lists of a root are cut
+           from the start of the buffer one after another, and the next
+           root cuts its own over them, so the buffer only grows when a
+           root needs more than any root before it.
+*/
+
+struct NeighborArena
+{
+    int* base; //!< the buffer
+    long capacity; //!< its size in ints
+};
+
+typedef struct NeighborArena NeighborArena;
+
+#define BITSET_MAX_BITS 256 //!< the largest P the recursion moves to bitsets
+#define BITSET_WORDS (BITSET_MAX_BITS/64) //!< 64-bit words in a bitset of BITSET_MAX_BITS
+#define BITSET_DEFAULT_BITS 64 //!< the default of -b
+#define BITSET_DEFAULT_DENSITY 0.0 //!< the default of -bdensity
+
+/*! \struct BitsetGraph
+
+    \brief The subgraph induced by a small P, relabeled 0 to |P|-1, as rows
+           of an adjacency bit matrix. Once P has at most maxBits vertices
+           and is dense enough, the recursion below it keeps its sets as
+           bitsets over these labels: the neighbors of a vertex in P are
+           one AND, and their number one popcount per word.
+*/
+
+struct BitsetGraph
+{
+    int maxBits; //!< switch to bitsets once |P| is at most this (64, 128 or 256)
+    double minDensity; //!< and P has at least this fraction of all possible edges
+    int numWords; //!< the words in use, for the current P
+    int vertex[BITSET_MAX_BITS]; //!< the vertex with each label
+    uint64_t adjacency[BITSET_MAX_BITS][BITSET_WORDS]; //!< the neighbors of each label, as labels
+};
+
+typedef struct BitsetGraph BitsetGraph;
+
+/*! \struct PivotFrame
+
+    \brief A call of the pivot recursion that is branching on its
+           candidates, kept on the stack of a PivotSearch instead of the
+           call stack. The candidates before next have had their branch
+           and are in X, except the last of them, which is in R while its
+           branch runs.
+*/
+
+struct PivotFrame
+{
+    int beginX; //!< the index where X begins in vertexSets
+    int beginP; //!< the index where P begins; moves right as candidates go to X
+    int beginR; //!< the index where R begins; moves right with beginP
+    int keep; //!< the number of vertices of R that are not pivots
+    int drop; //!< the number of pivots in R
+    int pivot; //!< the pivot of the call
+    int numCandidates; //!< the size of P minus the neighbors of the pivot
+    int next; //!< the index of the next candidate to branch on
+    int* candidates; //!< P minus the neighbors of the pivot, from the CandidateStack
+};
+
+typedef struct PivotFrame PivotFrame;
+
+/*! \struct PivotSearch
+
+    \brief The state of one run of the pivot recursion: the sets X, P and
+           R shared by every call, the calls on the path from the current
+           root that are branching, and what the leaves add their cliques
+           to. Since no state lives on the call stack, a search can stop
+           after any number of calls and go on from there later.
+*/
+
+struct PivotSearch
+{
+    int* vertexSets; //!< the vertices, divided into X, P and R
+    int* vertexLookup; //!< the index of each vertex in vertexSets
+    int** neighborsInP; //!< the neighbors of each vertex, those in P first
+    int* numNeighbors; //!< the number of neighbors of each vertex in the P of its root
+    CandidateStack* candidates; //!< the candidate arrays of the frames
+    NeighborArena* arena; //!< the buffer of the neighborsInP lists
+    BitsetGraph* bitset; //!< the bit matrix for small P, or NULL
+    PivotFrame* frames; //!< the calls that are branching, from the root up
+    int depth; //!< the number of frames
+    count_t* cliqueCounts; //!< the counts the leaves add to
+    int min_k; //!< the smallest clique size to count
+    int max_k; //!< the largest clique size to count
+    int* keepV; //!< the vertices of R that are not pivots
+    int* dropV; //!< the pivots in R
+    TwinWeights* twins; //!< the weights and scratch space, or NULL if twins were not collapsed
+    int* ordering; //!< E mode: the position of each vertex in the ordering
+    long* CSCindex; //!< E mode: the offsets of the oriented adjacency lists
+    int* CSCedges; //!< E mode: the oriented adjacency lists
+    double nCalls; //!< A mode: the number of calls
+    double sumP; //!< A mode: the sum of the sizes of P over the calls
+    double sqP; //!< A mode: the sum of their squares
+};
+
+typedef struct PivotSearch PivotSearch;
+
 #include"LinkedList.h"
+#include"graph_io.h"
 #include"degeneracy_helper.h"
 #include"degeneracy_algorithm_cliques_A.h"
 #include"degeneracy_algorithm_cliques_V.h"
@@ -37,9 +193,62 @@
 
 #define max(x,y) (x > y? x:y)
 #define min(x,y) (x < y? x:y)
-#define MAX_CSIZE 400
 
-void populate_nCr();
+/*! \brief take an array of candidates from the top of the stack.
+
+    \param stack the stack of the current run
+
+    \param size the number of ints needed
+
+    \return the array, valid until it is given back with popCandidates.
+*/
+
+static inline int* pushCandidates(CandidateStack* stack, int size)
+{
+    if (stack->top + size > stack->capacity)
+    {
+        fprintf(stderr, "ERROR, the candidate stack of %ld ints is full, the recursion is deeper than the degeneracy allows...\n", stack->capacity);
+        exit(1);
+    }
+
+    int* candidates = stack->base + stack->top;
+    stack->top += size;
+    return candidates;
+}
+
+/*! \brief give an array of candidates back, with every array taken after it.
+
+    \param stack the stack the array was taken from
+
+    \param candidates the array, from pushCandidates
+*/
+
+static inline void popCandidates(CandidateStack* stack, int* candidates)
+{
+    stack->top = candidates - stack->base;
+}
+
+/*! \brief the number of vertices in a bitset.
+
+    \param set the bitset
+
+    \param numWords its size in words
+
+    \return the number of bits set.
+*/
+
+static inline int bitsetCount(const uint64_t* set, int numWords)
+{
+    return setKernels.bitsetCount(set, numWords);
+}
+
+#define AUTO_ORDER_SAMPLES 1000 //!< the number of roots -r auto runs the recursion from for each ordering
+
+extern count_t** nCr;
+
+void populate_nCr(int maxRow);
+
+void destroy_nCr();
 
 int nodeComparator(void* node1, void* node2);
 
@@ -53,19 +262,25 @@ void destroyCliqueResults(LinkedList* cliques);
 
 LinkedList** readInGraphAdjList(int* n, int* m);
 
-LinkedList** readInGraphAdjListToDoubleEdges(int* n, int* m, char *fpath);
 
+int twinKeepPolynomial(count_t* poly, int* keepV, int keep, int skipA, int skipB, int* weight, int max_k);
+
+count_t twinBinomialSum(count_t* poly, int lowest, int total, int t);
+
+void shuffleVertices(int* shuffled, int n);
 
-void runAndPrintStatsCliques(LinkedList** adjListLinked,
-                               int n, const char * gname, 
-                               char T, int max_k, int flag_d, int flag_o);
+double estimateRecursionCost(OrientedGraph* orientedGraph, int n, int degeneracy, int max_k,
+                             int* shuffled, int numRoots, double budget, int* skipped,
+                             double* sampledCost, double* sampledSeconds);
 
+void runAndPrintStatsCliques(CSRGraph* graph, const char * gname, 
+                               char T, int min_k, int max_k, int flag_d, int flag_o, int flag_c, int flag_twins,
+                               int bitsetBits, double bitsetDensity,
+                               double epsilon, int order,
+                               const char* orderIn, const char* orderOut);
 
-int findNbrCSC(int u, int v, int *CSCindex, int *CSCedges);
 
-void moveFromRToXDegeneracyCliques( int vertex, 
-                                    int* vertexSets, int* vertexLookup, 
-                                    int* pBeginX, int* pBeginP, int* pBeginR);
+long findNbrCSC(int u, int v, long *CSCindex, int *CSCedges);
 
 void moveToRDegeneracyCliques( int vertex, 
                                int* vertexSets, int* vertexLookup, 
@@ -73,17 +288,208 @@ void moveToRDegeneracyCliques( int vertex,
                                int* pBeginX, int *pBeginP, int *pBeginR, 
                                int* pNewBeginX, int* pNewBeginP, int *pNewBeginR);
 
-void fillInPandXForRecursiveCallDegeneracyCliques( int vertex, int orderNumber,
+void fillInPandXForRecursiveCallDegeneracyCliques( int vertex,
                                                    int* vertexSets, int* vertexLookup, 
-                                                   NeighborListArray** orderingArray,
+                                                   OrientedGraph* orientedGraph,
                                                    int** neighborsInP, int* numNeighbors,
                                                    int* pBeginX, int *pBeginP, int *pBeginR, 
-                                                   int* pNewBeginX, int* pNewBeginP, int *pNewBeginR);
+                                                   int* pNewBeginX, int* pNewBeginP, int *pNewBeginR,
+                                                   NeighborArena* arena);
+
+CandidateStack* createCandidateStack(int maxOutDegree, int degeneracy);
+
+void destroyCandidateStack(CandidateStack* stack);
+
+NeighborArena* createNeighborArena();
+
+void destroyNeighborArena(NeighborArena* arena);
+
+BitsetGraph* createBitsetGraph(int maxBits, double minDensity);
+
+PivotSearch* createPivotSearch(OrientedGraph* orientedGraph, int size, int degeneracy, count_t* cliqueCounts,
+                               int min_k, int max_k, int bitsetBits, double bitsetDensity);
+
+void destroyPivotSearch(PivotSearch* search);
+
+int fillInBitsetForRecursiveCall( BitsetGraph* bitset,
+                                  int* vertexSets, int* vertexLookup,
+                                  int** neighborsInP, int* numNeighbors,
+                                  int beginP, int beginR, uint64_t* setP );
+
+int findBestPivotBitset(BitsetGraph* bitset, const uint64_t* setP);
 
 int findBestPivotNonNeighborsDegeneracyCliques( int** pivotNonNeighbors, int* numNonNeighbors,
                                                 int* vertexSets, int* vertexLookup,
                                                 int** neighborsInP, int* numNeighbors,
-                                                int beginX, int beginP, int beginR);
+                                                int beginX, int beginP, int beginR,
+                                                CandidateStack* candidates);
 
-#endif
+/*! \brief start branching on a call: choose its pivot and push a frame
+           with the candidates.
+
+    \param search the search
+
+    \param beginX The index where set X begins in vertexSets.
+
+    \param beginP The index where set P begins in vertexSets. P is not empty.
+
+    \param beginR The index where set R begins in vertexSets.
+
+    \param keep the number of vertices of R that are not pivots
+
+    \param drop the number of pivots in R
+*/
+
+static inline void pushPivotFrame(PivotSearch* search, int beginX, int beginP, int beginR, int keep, int drop)
+{
+    PivotFrame* frame = &search->frames[search->depth++];
+
+    frame->beginX = beginX;
+    frame->beginP = beginP;
+    frame->beginR = beginR;
+    frame->keep = keep;
+    frame->drop = drop;
+    frame->next = 0;
+    frame->pivot = findBestPivotNonNeighborsDegeneracyCliques( &frame->candidates, &frame->numCandidates,
+                                                               search->vertexSets, search->vertexLookup,
+                                                               search->neighborsInP, search->numNeighbors,
+                                                               beginX, beginP, beginR, search->candidates);
+}
+
+/*! \brief Move a vertex from the set R to the set X, and update all necessary pointers
+           and arrays of neighbors in P
+
+    \param vertex The vertex to move from R to X.
+
+    \param vertexSets An array containing sets of vertices divided into sets X, P, R, and other.
+ 
+    \param vertexLookup A lookup table indexed by vertex number, storing the index of that 
+                        vertex in vertexSets.
+
+    \param pBeginP The index where set P begins in vertexSets.
+
+    \param pBeginR The index where set R begins in vertexSets.
+
+*/
+
+static inline void moveFromRToXDegeneracyCliques( int vertex, 
+                                                  int* vertexSets, int* vertexLookup, 
+                                                  int* pBeginP, int* pBeginR )
+{
+    int vertexLocation = vertexLookup[vertex];
+
+    //swap vertex into X and increment beginP and beginR
+    vertexSets[vertexLocation] = vertexSets[*pBeginP];
+    vertexLookup[vertexSets[*pBeginP]] = vertexLocation;
+    vertexSets[*pBeginP] = vertex;
+    vertexLookup[vertex] = *pBeginP;
 
+    *pBeginP = *pBeginP + 1;
+    *pBeginR = *pBeginR + 1;
+}
+
+/*! \brief finish the call on top of the stack, whether or not it has
+           branched on all of its candidates: move its candidate in R to X,
+           and every candidate in X back into P, for the call below it.
+
+    \param search the search, with at least one frame
+*/
+
+static inline void popPivotFrame(PivotSearch* search)
+{
+    PivotFrame* frame = &search->frames[search->depth - 1];
+    int* vertexSets = search->vertexSets;
+    int* vertexLookup = search->vertexLookup;
+
+    if (frame->next > 0)
+        moveFromRToXDegeneracyCliques( frame->candidates[frame->next - 1],
+                                       vertexSets, vertexLookup,
+                                       &frame->beginP, &frame->beginR );
+
+    // swap vertices that were moved to X back into P, for higher recursive calls.
+    int beginP = frame->beginP;
+    int* candidates = frame->candidates;
+    int next = frame->next;
+    for (int iterator = 0; iterator < next; iterator++)
+    {
+        int vertex = candidates[iterator];
+        int vertexLocation = vertexLookup[vertex];
+
+        beginP--;
+        vertexSets[vertexLocation] = vertexSets[beginP];
+        vertexSets[beginP] = vertex;
+        vertexLookup[vertex] = beginP;
+        vertexLookup[vertexSets[vertexLocation]] = vertexLocation;
+    }
+
+    // give the candidates back; every frame above has given back its own
+    popCandidates(search->candidates, candidates);
+    search->depth--;
+}
+
+/*! \brief take one step of the recursion without recursing: move the
+           candidate of the top frame whose branch has finished to X and
+           the next one to R, or pop the frame if it has none left.
+
+    \param search the search, with at least one frame
+
+    \param pNewBeginX After function, contains the index where set X begins for the new call.
+
+    \param pNewBeginP After function, contains the index where set P begins for the new call.
+
+    \param pNewBeginR After function, contains the index where set R begins for the new call.
+
+    \param pKeep After function, contains the number of vertices of R that are not pivots in the new call.
+
+    \param pDrop After function, contains the number of pivots in R in the new call.
+
+    \return 1 if there is a new call, which the caller visits with the sets
+            above, and 0 if the top frame was popped instead.
+*/
+
+static inline int nextPivotCall(PivotSearch* search, int* pNewBeginX, int* pNewBeginP, int* pNewBeginR, int* pKeep, int* pDrop)
+{
+    PivotFrame* frame = &search->frames[search->depth - 1];
+
+    if (frame->next == frame->numCandidates)
+    {
+        popPivotFrame(search);
+        return 0;
+    }
+
+    if (frame->next > 0)
+        moveFromRToXDegeneracyCliques( frame->candidates[frame->next - 1],
+                                       search->vertexSets, search->vertexLookup,
+                                       &frame->beginP, &frame->beginR );
+
+    // swap the next candidate into R and update all data structures
+    int vertex = frame->candidates[frame->next++];
+    moveToRDegeneracyCliques( vertex,
+                              search->vertexSets, search->vertexLookup,
+                              search->neighborsInP, search->numNeighbors,
+                              &frame->beginX, &frame->beginP, &frame->beginR,
+                              pNewBeginX, pNewBeginP, pNewBeginR );
+
+    *pKeep = frame->keep;
+    *pDrop = frame->drop;
+    if (vertex == frame->pivot)
+        search->dropV[(*pDrop)++] = vertex;
+    else
+        search->keepV[(*pKeep)++] = vertex;
+
+    return 1;
+}
+
+/*! \brief give up on the rest of the current root: pop every frame,
+           leaving X, P and R as they were before the root was visited.
+
+    \param search the search
+*/
+
+static inline void abandonPivotSearch(PivotSearch* search)
+{
+    while (search->depth > 0)
+        popPivotFrame(search);
+}
+
+#endif
@@ -16,11 +16,19 @@
 #include<assert.h>
 #include<stdio.h>
 #include<stdlib.h>
+#include<string.h>
+#include<unistd.h>
+
+#include"misc.h"
+#include"MemoryManager.h"
+#include"degeneracy_helper.h"
+#include"degeneracy_algorithm_cliques_A.h"
+#include"graph_ingest.h"
 
 /*! \file printnm.c
 
-   \brief print the number of vertices and edges in an input
-          graph
+   \brief print the size, degree distribution and degeneracy of an
+          input graph, and predict how long counting its cliques takes
 
     \author Darren Strash (first name DOT last name AT gmail DOT com)
 
@@ -35,16 +43,222 @@
     \endhtmlonly
 */
 
-int main()
+/*! \brief print a histogram of degrees in buckets of doubling width:
+           0, 1, 2-3, 4-7 and so on.
+
+    \param title the name of the first column
+
+    \param degree the degree of each vertex
+
+    \param n the number of vertices
+*/
+
+static void printDegreeHistogram(const char* title, int* degree, int n)
 {
-    int n,m;
-
-    if(scanf("%d", &n)!=1)
-        exit(1);
-    fprintf(stderr, "Number of vertices: %d\n", n);
-    if(scanf("%d", &m)!=1)
-        exit(1);
-    fprintf(stderr, "Number of edges: %d\n", m/2);
+    long numInBucket[33];
+    int numBuckets = 0;
+    int i = 0;
+    int b = 0;
+
+    memset(numInBucket, 0, sizeof(numInBucket));
+
+    for (i = 0; i < n; i++)
+    {
+        // bucket b > 0 holds degrees 2^(b-1) to 2^b - 1
+        int bucket = 0;
+        while ((bucket < 32) && ((long)degree[i] >= (1L << bucket)))
+            bucket++;
+        numInBucket[bucket]++;
+        numBuckets = max(numBuckets, bucket + 1);
+    }
+
+    printf("%s,vertices\n", title);
+    for (b = 0; b < numBuckets; b++)
+    {
+        if (b <= 1)
+            printf("%d,%ld\n", b, numInBucket[b]);
+        else
+            printf("%ld-%ld,%ld\n", 1L << (b-1), (1L << b) - 1, numInBucket[b]);
+    }
+    printf("\n");
+}
+
+/*! \brief print the out-degrees under one ordering, and estimate the work
+           and the time of the pivot recursion (the A mode, on one thread)
+           by running it from a sample of roots.
+
+    \param graph an input graph, in compressed sparse row format
+
+    \param order one of the ORDER_ constants except ORDER_AUTO
+
+    \param degeneracy the degeneracy of the graph
+
+    \param max_k the largest clique size to count
+
+    \param shuffled all vertices in a random order
+
+    \param numRoots the number of roots to run the recursion from
+*/
+
+static void printOrderStats(CSRGraph* graph, int order, int degeneracy, int max_k, int* shuffled, int numRoots)
+{
+    int n = graph->n;
+    int* ordering = (int*) Calloc(max(n, 1), sizeof(int));
+    int* position = (int*) Calloc(max(n, 1), sizeof(int));
+    int* outDegree = (int*) Calloc(max(n, 1), sizeof(int));
+    double sumSquares = 0;
+    double sumCubes = 0;
+    int maxOutDegree = 0;
+    int skipped = 0;
+    double sampledCost = 0;
+    int i = 0;
+
+    computeVertexOrder(graph, order, ordering, position);
+    OrientedGraph* orientedGraph = computeOrientedGraph(graph, ordering, position, 0);
+
+    for (i = 0; i < n; i++)
+    {
+        double d = numLater(orientedGraph, i);
+        outDegree[i] = numLater(orientedGraph, i);
+        maxOutDegree = max(maxOutDegree, outDegree[i]);
+        sumSquares += d*d;
+        sumCubes += d*d*d;
+    }
+
+    printf("Ordering %s: max out-degree %d, sum of squared out-degrees %.0lf, sum of cubed out-degrees %.0lf.\n",
+           vertexOrderName(order), maxOutDegree, sumSquares, sumCubes);
+    printDegreeHistogram("out-degree", outDegree, n);
+
+    double seconds = 0;
+    double cost = estimateRecursionCost(orientedGraph, n, degeneracy, max_k, shuffled, numRoots, -1, &skipped, &sampledCost, &seconds);
+
+    // the sampled roots run at the same rate per unit of cost as the rest
+    printf("Ordering %s: estimated recursion cost %.0lf from %d roots in %lf seconds", vertexOrderName(order), cost, numRoots, seconds);
+    if (sampledCost > 0)
+        printf(", predicted counting time %lf seconds.\n\n", cost*seconds/sampledCost);
+    else
+        printf(".\n\n");
+
+    destroyOrientedGraph(orientedGraph);
+    Free(ordering);
+    Free(position);
+    Free(outDegree);
+}
+
+int main(int argc, char** argv)
+{
+    int opt;
+    char *fpath = NULL;
+    int format = FORMAT_EDGES;
+    int order = ORDER_DEGENERACY;
+    int max_k = 0;
+    int numRoots = AUTO_ORDER_SAMPLES;
+
+    while((opt = getopt(argc, argv, ":i:f:r:k:s:")) != -1)
+    {
+        switch(opt)
+        {
+            case 'i':
+                fpath = optarg;
+                break;
+            case 'f':
+                format = parseGraphFormat(optarg);
+                if (format < 0)
+                {
+                    printf("Incorrect format. Format should be edges, snap, csv, mtx or metis.\n");
+                    return 0;
+                }
+                break;
+            case 'r':
+                order = parseVertexOrder(optarg);
+                if (order < 0)
+                {
+                    printf("Incorrect ordering. Ordering should be degen, degree, degen-degree, degen-id, color or auto.\n");
+                    return 0;
+                }
+                break;
+            case 'k':
+                max_k = atoi(optarg);
+                break;
+            case 's':
+                numRoots = atoi(optarg);
+                break;
+            default:
+                printf("./printnm [-i <file_path>] [-f <format>] [-r <ordering>] [-k <max_clique_size>] [-s <samples>]\n");
+                printf("file_path: path to file, or a directory or quoted glob pattern of shards. Without it only n and m are read from stdin and printed.\n");
+                printf("format: edges (default), snap, csv, mtx or metis.\n");
+                printf("ordering: degen (default), degree, degen-degree, degen-id, color, or auto for all of them.\n");
+                printf("max_clique_size: the max_clique_size the counting run will use. If 0 (default), all k.\n");
+                printf("samples: the number of roots to run the recursion from for the prediction, half of them the heaviest (default %d).\n", AUTO_ORDER_SAMPLES);
+                return 0;
+        }
+    }
+
+    if (fpath == NULL)
+    {
+        int n,m;
+
+        if(scanf("%d", &n)!=1)
+            exit(1);
+        fprintf(stderr, "Number of vertices: %d\n", n);
+        if(scanf("%d", &m)!=1)
+            exit(1);
+        fprintf(stderr, "Number of edges: %d\n", m/2);
+
+        return 0;
+    }
+
+    // time the sample with the kernels a counting run would pick
+    selectSetKernels(SET_KERNELS_AUTO);
+
+    CSRGraph* graph = loadGraphCSR(fpath, format);
+    int n = graph->n;
+    int* degree = (int*) Calloc(max(n, 1), sizeof(int));
+    int* core = (int*) Calloc(max(n, 1), sizeof(int));
+    int maxDegree = 0;
+    int minDegree = (n > 0) ? graph->offsets[1] - graph->offsets[0] : 0;
+    int i = 0;
+
+    for (i = 0; i < n; i++)
+    {
+        degree[i] = (int)(graph->offsets[i+1] - graph->offsets[i]);
+        maxDegree = max(maxDegree, degree[i]);
+        minDegree = min(minDegree, degree[i]);
+    }
+
+    int degeneracy = computeCoreNumbers(graph, core);
+
+    if (max_k == 0) max_k = degeneracy + 1;
+    numRoots = max(0, min(n, numRoots));
+
+    printf("Number of vertices: %d\n", n);
+    printf("Number of edges: %ld\n", graph->m/2);
+    printf("Degree: min %d, max %d, average %lf\n", minDegree, maxDegree, (n > 0) ? (double)graph->m/n : 0.0);
+    printf("Degeneracy: %d\n", degeneracy);
+    printf("Memory for the counts: V mode %.0lf bytes, E mode %.0lf bytes\n\n",
+           (double)n*(max_k + 1)*sizeof(count_t), (double)(graph->m/2)*(max_k + 1)*sizeof(count_t));
+
+    printDegreeHistogram("degree", degree, n);
+
+    int* shuffled = (int*) Calloc(max(n, 1), sizeof(int));
+    shuffleVertices(shuffled, n);
+
+    populate_nCr(degeneracy + 1);
+
+    if (order == ORDER_AUTO)
+    {
+        for (order = 0; order < NUM_VERTEX_ORDERS; order++)
+            printOrderStats(graph, order, degeneracy, max_k, shuffled, numRoots);
+    }
+    else
+        printOrderStats(graph, order, degeneracy, max_k, shuffled, numRoots);
+
+    destroy_nCr();
+
+    Free(shuffled);
+    Free(degree);
+    Free(core);
+    destroyCSRGraph(graph);
 
     return 0;
 }
@@ -0,0 +1,397 @@
+/*
+    This file contains the algorithm for listing all cliques
+    according to the algorithm of Jain et al. specified in
+    "The power of pivoting for exact clique counting." (WSDM 2020).
+
+    This code is a modified version of the code of quick-cliques-1.0 library for counting
+    maximal cliques by Darren Strash (first name DOT last name AT gmail DOT com).
+
+    Original author: Darren Strash (first name DOT last name AT gmail DOT com)
+
+    Copyright (c) 2011 Darren Strash. This code is released under the GNU Public License (GPL) 3.0.
+
+    Modifications Copyright (c) 2020 Shweta Jain
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<immintrin.h>
+
+#include"set_kernels.h"
+
+// The binary is built for plain x86-64. The AVX2 and AVX-512 versions are
+// compiled for their instruction sets with target attributes, and
+// selectSetKernels picks one at run time from what the CPU reports, so the
+// same binary runs everywhere. The scalar bodies below are inlined into
+// every version, as its tail loop or as all of it.
+
+#define KERNEL_BODY static inline __attribute__((always_inline))
+
+KERNEL_BODY int prefixInRangeBody(const int* list, int i, int size, const int* vertexLookup, int begin, int end)
+{
+    while (i < size)
+    {
+        int location = vertexLookup[list[i]];
+        if ((location < begin) || (location >= end))
+            break;
+        i++;
+    }
+
+    return i;
+}
+
+KERNEL_BODY int partitionInRangeBody(int* list, int i, int size, int numInRange, const int* vertexLookup, int begin, int end)
+{
+    while (i < size)
+    {
+        int neighbor = list[i];
+        int location = vertexLookup[neighbor];
+        if ((location >= begin) && (location < end))
+        {
+            list[i] = list[numInRange];
+            list[numInRange] = neighbor;
+            numInRange++;
+        }
+        i++;
+    }
+
+    return numInRange;
+}
+
+KERNEL_BODY int listContainsBody(const int* list, int i, int size, int value)
+{
+    while (i < size)
+    {
+        if (list[i] == value)
+            return 1;
+        i++;
+    }
+
+    return 0;
+}
+
+KERNEL_BODY int bitsetCountBody(const uint64_t* set, int numWords)
+{
+    int count = 0;
+    for (int w = 0; w < numWords; w++)
+        count += __builtin_popcountll(set[w]);
+    return count;
+}
+
+KERNEL_BODY int bitsetBestPivotBody(const uint64_t* rows, int rowWords, const uint64_t* set, int numWords)
+{
+    int pivot = -1;
+    int maxIntersectionSize = -1;
+
+    for (int w = 0; w < numWords; w++)
+    {
+        uint64_t word = set[w];
+        while (word != 0)
+        {
+            int label = 64*w + __builtin_ctzll(word);
+            const uint64_t* row = rows + (long)label*rowWords;
+            int intersectionSize = 0;
+
+            for (int x = 0; x < numWords; x++)
+                intersectionSize += __builtin_popcountll(row[x] & set[x]);
+
+            if (intersectionSize > maxIntersectionSize)
+            {
+                pivot = label;
+                maxIntersectionSize = intersectionSize;
+            }
+
+            word &= word - 1;
+        }
+    }
+
+    return pivot;
+}
+
+/*! \brief move the vertices of a chunk of list that are in P, marked by
+           the bits of inRange, to the front of list. Only positions up to
+           the current one are written, so the bits of later positions stay
+           valid.
+*/
+
+KERNEL_BODY int partitionChunk(int* list, int i, unsigned inRange, int numInRange)
+{
+    while (inRange != 0)
+    {
+        int k = i + __builtin_ctz(inRange);
+        int neighbor = list[k];
+        list[k] = list[numInRange];
+        list[numInRange] = neighbor;
+        numInRange++;
+        inRange &= inRange - 1;
+    }
+
+    return numInRange;
+}
+
+static int prefixInRangeScalar(const int* list, int size, const int* vertexLookup, int begin, int end)
+{
+    return prefixInRangeBody(list, 0, size, vertexLookup, begin, end);
+}
+
+static int partitionInRangeScalar(int* list, int size, const int* vertexLookup, int begin, int end)
+{
+    return partitionInRangeBody(list, 0, size, 0, vertexLookup, begin, end);
+}
+
+static int listContainsScalar(const int* list, int size, int value)
+{
+    return listContainsBody(list, 0, size, value);
+}
+
+static int bitsetCountScalar(const uint64_t* set, int numWords)
+{
+    return bitsetCountBody(set, numWords);
+}
+
+static int bitsetBestPivotScalar(const uint64_t* rows, int rowWords, const uint64_t* set, int numWords)
+{
+    return bitsetBestPivotBody(rows, rowWords, set, numWords);
+}
+
+/*! \brief the in P mask of 8 vertices of a list: gather their locations
+           and compare them with begin and end.
+*/
+
+__attribute__((target("avx2,popcnt")))
+static inline unsigned inRangeAVX2(const int* list, const int* vertexLookup, __m256i beforeBegin, __m256i end)
+{
+    __m256i neighbors = _mm256_loadu_si256((const __m256i*)list);
+    __m256i locations = _mm256_i32gather_epi32(vertexLookup, neighbors, 4);
+    __m256i inRange = _mm256_and_si256(_mm256_cmpgt_epi32(locations, beforeBegin), _mm256_cmpgt_epi32(end, locations));
+    return (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(inRange));
+}
+
+__attribute__((target("avx2,popcnt")))
+static int prefixInRangeAVX2(const int* list, int size, const int* vertexLookup, int begin, int end)
+{
+    __m256i beforeBegin = _mm256_set1_epi32(begin - 1);
+    __m256i endVector = _mm256_set1_epi32(end);
+    int i = 0;
+
+    for (; i + 8 <= size; i += 8)
+    {
+        unsigned inRange = inRangeAVX2(list + i, vertexLookup, beforeBegin, endVector);
+        if (inRange != 0xFF)
+            return i + __builtin_ctz(~inRange);
+    }
+
+    return prefixInRangeBody(list, i, size, vertexLookup, begin, end);
+}
+
+__attribute__((target("avx2,popcnt")))
+static int partitionInRangeAVX2(int* list, int size, const int* vertexLookup, int begin, int end)
+{
+    __m256i beforeBegin = _mm256_set1_epi32(begin - 1);
+    __m256i endVector = _mm256_set1_epi32(end);
+    int numInRange = 0;
+    int i = 0;
+
+    for (; i + 8 <= size; i += 8)
+        numInRange = partitionChunk(list, i, inRangeAVX2(list + i, vertexLookup, beforeBegin, endVector), numInRange);
+
+    return partitionInRangeBody(list, i, size, numInRange, vertexLookup, begin, end);
+}
+
+__attribute__((target("avx2,popcnt")))
+static int listContainsAVX2(const int* list, int size, int value)
+{
+    __m256i valueVector = _mm256_set1_epi32(value);
+    int i = 0;
+
+    for (; i + 8 <= size; i += 8)
+    {
+        __m256i equal = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(list + i)), valueVector);
+        if (!_mm256_testz_si256(equal, equal))
+            return 1;
+    }
+
+    return listContainsBody(list, i, size, value);
+}
+
+__attribute__((target("avx2,popcnt")))
+static int bitsetCountPopcnt(const uint64_t* set, int numWords)
+{
+    return bitsetCountBody(set, numWords);
+}
+
+__attribute__((target("avx2,popcnt")))
+static int bitsetBestPivotPopcnt(const uint64_t* rows, int rowWords, const uint64_t* set, int numWords)
+{
+    return bitsetBestPivotBody(rows, rowWords, set, numWords);
+}
+
+/*! \brief the in P mask of up to 16 vertices of a list, the ones in
+           active: a masked gather of their locations, and one unsigned
+           compare of location - begin with end - begin.
+*/
+
+__attribute__((target("avx512f,popcnt")))
+static inline __mmask16 inRangeAVX512(const int* list, __mmask16 active, const int* vertexLookup, __m512i begin, __m512i width)
+{
+    __m512i neighbors = _mm512_maskz_loadu_epi32(active, list);
+    __m512i locations = _mm512_mask_i32gather_epi32(_mm512_setzero_si512(), active, neighbors, vertexLookup, 4);
+    return _mm512_mask_cmplt_epu32_mask(active, _mm512_sub_epi32(locations, begin), width);
+}
+
+/*! \brief the lanes of a chunk of 16 that lie inside a list of the given
+           size, so that the last chunk needs no scalar tail.
+*/
+
+static inline __mmask16 activeLanes(int remaining)
+{
+    return (remaining >= 16) ? (__mmask16)0xFFFF : (__mmask16)((1u << remaining) - 1);
+}
+
+__attribute__((target("avx512f,popcnt")))
+static int prefixInRangeAVX512(const int* list, int size, const int* vertexLookup, int begin, int end)
+{
+    __m512i beginVector = _mm512_set1_epi32(begin);
+    __m512i width = _mm512_set1_epi32(end - begin);
+
+    for (int i = 0; i < size; i += 16)
+    {
+        __mmask16 active = activeLanes(size - i);
+        __mmask16 inRange = inRangeAVX512(list + i, active, vertexLookup, beginVector, width);
+        if (inRange != active)
+            return i + __builtin_ctz(~(unsigned)inRange);
+    }
+
+    return size;
+}
+
+__attribute__((target("avx512f,popcnt")))
+static int partitionInRangeAVX512(int* list, int size, const int* vertexLookup, int begin, int end)
+{
+    __m512i beginVector = _mm512_set1_epi32(begin);
+    __m512i width = _mm512_set1_epi32(end - begin);
+    int numInRange = 0;
+
+    for (int i = 0; i < size; i += 16)
+    {
+        __mmask16 inRange = inRangeAVX512(list + i, activeLanes(size - i), vertexLookup, beginVector, width);
+        numInRange = partitionChunk(list, i, inRange, numInRange);
+    }
+
+    return numInRange;
+}
+
+__attribute__((target("avx512f,popcnt")))
+static int listContainsAVX512(const int* list, int size, int value)
+{
+    __m512i valueVector = _mm512_set1_epi32(value);
+
+    for (int i = 0; i < size; i += 16)
+    {
+        __mmask16 active = activeLanes(size - i);
+        if (_mm512_mask_cmpeq_epi32_mask(active, _mm512_maskz_loadu_epi32(active, list + i), valueVector) != 0)
+            return 1;
+    }
+
+    return 0;
+}
+
+static const SetKernels scalarKernels = {
+    "scalar", prefixInRangeScalar, partitionInRangeScalar, listContainsScalar,
+    bitsetCountScalar, bitsetBestPivotScalar
+};
+
+static const SetKernels avx2Kernels = {
+    "avx2", prefixInRangeAVX2, partitionInRangeAVX2, listContainsAVX2,
+    bitsetCountPopcnt, bitsetBestPivotPopcnt
+};
+
+static const SetKernels avx512Kernels = {
+    "avx512", prefixInRangeAVX512, partitionInRangeAVX512, listContainsAVX512,
+    bitsetCountPopcnt, bitsetBestPivotPopcnt
+};
+
+// the kernels in use; scalar until selectSetKernels is called
+SetKernels setKernels = scalarKernels;
+
+/*! \brief map a name given to -simd to one of the SET_KERNELS_ constants.
+
+    \param name one of auto, scalar, avx2, avx512
+
+    \return the level, or -2 if the name is not known.
+*/
+
+int parseSetKernels(const char* name)
+{
+    if (strcmp(name, "auto") == 0) return SET_KERNELS_AUTO;
+    if (strcmp(name, "scalar") == 0) return SET_KERNELS_SCALAR;
+    if (strcmp(name, "avx2") == 0) return SET_KERNELS_AVX2;
+    if (strcmp(name, "avx512") == 0) return SET_KERNELS_AVX512;
+    return -2;
+}
+
+/*! \brief whether the CPU (and the operating system, which has to save
+           the wider registers) supports a level of kernels.
+
+    \param level one of the SET_KERNELS_ constants other than auto
+
+    \return 1 if the kernels of that level can run here, 0 otherwise.
+*/
+
+int setKernelsSupported(int level)
+{
+    __builtin_cpu_init();
+
+    if (level == SET_KERNELS_SCALAR)
+        return 1;
+    if (level == SET_KERNELS_AVX2)
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+    if (level == SET_KERNELS_AVX512)
+        return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("popcnt");
+    return 0;
+}
+
+/*! \brief choose the kernels the recursion uses from now on.
+
+    \param level one of the SET_KERNELS_ constants. Auto, or a level the
+                 CPU does not support, selects the best supported level.
+
+    \return the level selected.
+*/
+
+int selectSetKernels(int level)
+{
+    if ((level != SET_KERNELS_AUTO) && !setKernelsSupported(level))
+    {
+        fprintf(stderr, "This CPU does not support the %s kernels, using the best it supports.\n",
+                (level == SET_KERNELS_AVX512) ? "avx512" : "avx2");
+        level = SET_KERNELS_AUTO;
+    }
+
+    if (level == SET_KERNELS_AUTO)
+    {
+        level = SET_KERNELS_SCALAR;
+        if (setKernelsSupported(SET_KERNELS_AVX2)) level = SET_KERNELS_AVX2;
+        if (setKernelsSupported(SET_KERNELS_AVX512)) level = SET_KERNELS_AVX512;
+    }
+
+    if (level == SET_KERNELS_AVX512) setKernels = avx512Kernels;
+    else if (level == SET_KERNELS_AVX2) setKernels = avx2Kernels;
+    else setKernels = scalarKernels;
+
+    return level;
+}
@@ -0,0 +1,67 @@
+#ifndef _DJS_SET_KERNELS_H_
+#define _DJS_SET_KERNELS_H_
+
+/*
+    This file contains the algorithm for listing all cliques
+    according to the algorithm of Jain et al. specified in
+    "The power of pivoting for exact clique counting." (WSDM 2020).
+
+    This code is a modified version of the code of quick-cliques-1.0 library for counting
+    maximal cliques by Darren Strash (first name DOT last name AT gmail DOT com).
+
+    Original author: Darren Strash (first name DOT last name AT gmail DOT com)
+
+    Copyright (c) 2011 Darren Strash. This code is released under the GNU Public License (GPL) 3.0.
+
+    Modifications Copyright (c) 2020 Shweta Jain
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include<stdint.h>
+
+#define SET_KERNELS_AUTO -1 //!< the best kernels this CPU supports
+#define SET_KERNELS_SCALAR 0 //!< plain C loops, for every x86-64 CPU
+#define SET_KERNELS_AVX2 1 //!< AVX2 gathers and compares, and POPCNT
+#define SET_KERNELS_AVX512 2 //!< AVX-512 masked gathers and compares, and POPCNT
+
+/*! \struct SetKernels
+
+    \brief The inner loops of the recursion over P, in one version per
+           instruction set. The lists are the arrays of neighborsInP, and a
+           vertex is in P when its vertexLookup entry is in [begin, end).
+           Every version gives the same results.
+*/
+
+struct SetKernels
+{
+    const char* name; //!< scalar, avx2 or avx512
+    int (*prefixInRange)(const int* list, int size, const int* vertexLookup, int begin, int end); //!< the length of the prefix of list in P
+    int (*partitionInRange)(int* list, int size, const int* vertexLookup, int begin, int end); //!< move the vertices of list in P to its front, keeping their order, and count them
+    int (*listContains)(const int* list, int size, int value); //!< 1 if value is in list
+    int (*bitsetCount)(const uint64_t* set, int numWords); //!< the number of bits set
+    int (*bitsetBestPivot)(const uint64_t* rows, int rowWords, const uint64_t* set, int numWords); //!< the label in set whose row has the most bits in set
+};
+
+typedef struct SetKernels SetKernels;
+
+extern SetKernels setKernels;
+
+int parseSetKernels(const char* name);
+
+int setKernelsSupported(int level);
+
+int selectSetKernels(int level);
+
+#endif
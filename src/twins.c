@@ -0,0 +1,281 @@
+/*
+    This file contains the algorithm for listing all cliques
+    according to the algorithm of Jain et al. specified in
+    "The power of pivoting for exact clique counting." (WSDM 2020).
+
+    This code is a modified version of the code of quick-cliques-1.0 library for counting
+    maximal cliques by Darren Strash (first name DOT last name AT gmail DOT com).
+
+    Original author: Darren Strash (first name DOT last name AT gmail DOT com)
+
+    Copyright (c) 2011 Darren Strash. This code is released under the GNU Public License (GPL) 3.0.
+
+    Modifications Copyright (c) 2020 Shweta Jain
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+
+#include"misc.h"
+#include"MemoryManager.h"
+#include"twins.h"
+
+/*! \brief a vertex with the hash of its closed neighborhood, for sorting
+           the vertices so that candidate twins end up next to each other.
+*/
+
+struct TwinKey
+{
+    uint64_t hash; //!< the sum of vertexHash over the closed neighborhood
+    int degree; //!< the degree of the vertex
+    int vertex; //!< the vertex
+};
+
+typedef struct TwinKey TwinKey;
+
+/*! \brief scatter the bits of a vertex id (splitmix64).
+
+    \param vertex a vertex
+
+    \return a 64-bit hash of vertex.
+*/
+
+static inline uint64_t vertexHash(int vertex)
+{
+    uint64_t z = (uint64_t)vertex + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30))*0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27))*0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/*! \brief order TwinKeys by degree, then hash, then vertex.
+*/
+
+static int twinKeyComparator(const void* a, const void* b)
+{
+    const TwinKey* x = (const TwinKey*)a;
+    const TwinKey* y = (const TwinKey*)b;
+
+    if (x->degree != y->degree) return (x->degree < y->degree) ? -1 : 1;
+    if (x->hash != y->hash) return (x->hash < y->hash) ? -1 : 1;
+    return (x->vertex > y->vertex) - (x->vertex < y->vertex);
+}
+
+/*! \brief find the classes of true twins: vertices u and v with
+           N(u) + u = N(v) + v. Vertices are grouped by degree and by an
+           order-independent hash of their closed neighborhood, and twins
+           are confirmed within a group by comparing neighborhoods, so hash
+           collisions cannot merge vertices that are not twins.
+
+    \param graph an input graph, in compressed sparse row format, without
+                 self-loops or repeated edges
+
+    \return the twin classes. A vertex without twins is a class of one.
+*/
+
+TwinClasses* findTwinClasses(CSRGraph* graph)
+{
+    int size = graph->n;
+    int i = 0;
+
+    TwinKey* keys = (TwinKey*) Calloc(max(size, 1), sizeof(TwinKey));
+    for (i = 0; i < size; i++)
+    {
+        uint64_t hash = vertexHash(i);
+        long neighborIndex = 0;
+
+        for (neighborIndex = graph->offsets[i]; neighborIndex < graph->offsets[i+1]; neighborIndex++)
+            hash += vertexHash(graph->neighbors[neighborIndex]);
+
+        keys[i].hash = hash;
+        keys[i].degree = (int)(graph->offsets[i+1] - graph->offsets[i]);
+        keys[i].vertex = i;
+    }
+
+    qsort(keys, size, sizeof(TwinKey), twinKeyComparator);
+
+    // representative[v] is the smallest vertex of the class of v;
+    // stamp[u] == v + 1 marks u as in the closed neighborhood of v
+    int* representative = (int*) Calloc(max(size, 1), sizeof(int));
+    int* stamp = (int*) Calloc(max(size, 1), sizeof(int));
+    for (i = 0; i < size; i++)
+        representative[i] = -1;
+
+    int groupBegin = 0;
+    while (groupBegin < size)
+    {
+        int groupEnd = groupBegin + 1;
+        while ((groupEnd < size) && (keys[groupEnd].degree == keys[groupBegin].degree)
+                                 && (keys[groupEnd].hash == keys[groupBegin].hash))
+            groupEnd++;
+
+        // the group is sorted by vertex, so the first vertex left
+        // unassigned is the smallest of its class
+        for (int first = groupBegin; first < groupEnd; first++)
+        {
+            int vertex = keys[first].vertex;
+            if (representative[vertex] != -1) continue;
+
+            representative[vertex] = vertex;
+            if (groupEnd - first == 1) break;
+
+            stamp[vertex] = vertex + 1;
+            for (long neighborIndex = graph->offsets[vertex]; neighborIndex < graph->offsets[vertex+1]; neighborIndex++)
+                stamp[graph->neighbors[neighborIndex]] = vertex + 1;
+
+            for (int other = first + 1; other < groupEnd; other++)
+            {
+                int candidate = keys[other].vertex;
+                if ((representative[candidate] != -1) || (stamp[candidate] != vertex + 1)) continue;
+
+                // same degree, so containment means equality
+                long neighborIndex = graph->offsets[candidate];
+                while ((neighborIndex < graph->offsets[candidate+1]) && (stamp[graph->neighbors[neighborIndex]] == vertex + 1))
+                    neighborIndex++;
+
+                if (neighborIndex == graph->offsets[candidate+1])
+                    representative[candidate] = vertex;
+            }
+        }
+
+        groupBegin = groupEnd;
+    }
+
+    TwinClasses* classes = (TwinClasses*) Calloc(1, sizeof(TwinClasses));
+    classes->numVertices = size;
+
+    // number the classes in order of their smallest vertex, reusing
+    // stamp as the class of every vertex
+    int numClasses = 0;
+    for (i = 0; i < size; i++)
+    {
+        if (representative[i] == i)
+            stamp[i] = numClasses++;
+        else
+            stamp[i] = stamp[representative[i]];
+    }
+
+    classes->numClasses = numClasses;
+    classes->weight = (int*) Calloc(max(numClasses, 1), sizeof(int));
+    classes->memberOffsets = (long*) Calloc(numClasses + 1, sizeof(long));
+    classes->members = (int*) Calloc(max(size, 1), sizeof(int));
+
+    for (i = 0; i < size; i++)
+        classes->weight[stamp[i]]++;
+    for (i = 0; i < numClasses; i++)
+        classes->memberOffsets[i+1] = classes->memberOffsets[i] + classes->weight[i];
+
+    long* next = (long*) Calloc(max(numClasses, 1), sizeof(long));
+    memcpy(next, classes->memberOffsets, numClasses*sizeof(long));
+    for (i = 0; i < size; i++)
+        classes->members[next[stamp[i]]++] = i;
+
+    Free(next);
+    Free(keys);
+    Free(representative);
+    Free(stamp);
+
+    return classes;
+}
+
+/*! \brief build the graph with one vertex per twin class, where two
+           classes are adjacent if their vertices are.
+
+    \param graph an input graph, in compressed sparse row format
+
+    \param classes the twin classes of graph, from findTwinClasses
+
+    \return the collapsed graph, whose vertex c is class c.
+*/
+
+CSRGraph* collapseTwinClasses(CSRGraph* graph, TwinClasses* classes)
+{
+    int numClasses = classes->numClasses;
+    int* classOf = (int*) Calloc(max(graph->n, 1), sizeof(int));
+    int* stamp = (int*) Calloc(max(numClasses, 1), sizeof(int));
+    int c = 0;
+
+    for (c = 0; c < numClasses; c++)
+    {
+        for (long i = classes->memberOffsets[c]; i < classes->memberOffsets[c+1]; i++)
+            classOf[classes->members[i]] = c;
+    }
+
+    CSRGraph* collapsed = (CSRGraph*) Calloc(1, sizeof(CSRGraph));
+    collapsed->n = numClasses;
+    collapsed->offsets = (long*) Calloc(numClasses + 1, sizeof(long));
+
+    // every vertex of a class sees each neighboring class in full, once
+    // per vertex of that class; count each neighboring class once
+    for (c = 0; c < numClasses; c++)
+    {
+        int vertex = classes->members[classes->memberOffsets[c]];
+        long degree = 0;
+
+        stamp[c] = c + 1;
+        for (long neighborIndex = graph->offsets[vertex]; neighborIndex < graph->offsets[vertex+1]; neighborIndex++)
+        {
+            int neighborClass = classOf[graph->neighbors[neighborIndex]];
+            if (stamp[neighborClass] != c + 1)
+            {
+                stamp[neighborClass] = c + 1;
+                degree++;
+            }
+        }
+
+        collapsed->offsets[c+1] = collapsed->offsets[c] + degree;
+    }
+
+    collapsed->m = collapsed->offsets[numClasses];
+    collapsed->neighbors = (int*) Malloc(max(collapsed->m, 1)*sizeof(int));
+    memset(stamp, 0, max(numClasses, 1)*sizeof(int));
+
+    for (c = 0; c < numClasses; c++)
+    {
+        int vertex = classes->members[classes->memberOffsets[c]];
+        long next = collapsed->offsets[c];
+
+        stamp[c] = c + 1;
+        for (long neighborIndex = graph->offsets[vertex]; neighborIndex < graph->offsets[vertex+1]; neighborIndex++)
+        {
+            int neighborClass = classOf[graph->neighbors[neighborIndex]];
+            if (stamp[neighborClass] != c + 1)
+            {
+                stamp[neighborClass] = c + 1;
+                collapsed->neighbors[next++] = neighborClass;
+            }
+        }
+    }
+
+    Free(classOf);
+    Free(stamp);
+
+    return collapsed;
+}
+
+/*! \brief free the memory used by twin classes.
+
+    \param classes the twin classes
+*/
+
+void destroyTwinClasses(TwinClasses* classes)
+{
+    Free(classes->weight);
+    Free(classes->memberOffsets);
+    Free(classes->members);
+    Free(classes);
+}
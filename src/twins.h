@@ -0,0 +1,91 @@
+#ifndef _DJS_TWINS_H_
+#define _DJS_TWINS_H_
+
+/*
+    This file contains the algorithm for listing all cliques
+    according to the algorithm of Jain et al. specified in
+    "The power of pivoting for exact clique counting." (WSDM 2020).
+
+    This code is a modified version of the code of quick-cliques-1.0 library for counting
+    maximal cliques by Darren Strash (first name DOT last name AT gmail DOT com).
+
+    Original author: Darren Strash (first name DOT last name AT gmail DOT com)
+
+    Copyright (c) 2011 Darren Strash. This code is released under the GNU Public License (GPL) 3.0.
+
+    Modifications Copyright (c) 2020 Shweta Jain
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include"graph_io.h"
+
+/*! \struct TwinClasses
+
+    \brief The classes of true twins of a graph: vertices with the same
+           closed neighborhood. Every class is a clique, and every other
+           vertex is adjacent to all of a class or to none of it. Class c
+           holds the vertices members[memberOffsets[c]] to
+           members[memberOffsets[c+1]-1], in increasing order, and classes
+           are numbered in order of their smallest member.
+*/
+
+struct TwinClasses
+{
+    int numVertices; //!< the number of vertices of the graph
+    int numClasses; //!< the number of classes
+    int* weight; //!< the number of vertices in each class
+    long* memberOffsets; //!< numClasses+1 offsets into members
+    int* members; //!< the vertices of every class
+};
+
+typedef struct TwinClasses TwinClasses;
+
+/*! \brief the number of vertices in a twin class.
+
+    \param classes the twin classes, or NULL if twins were not collapsed
+
+    \param c a class, or a vertex if classes is NULL
+
+    \return the weight of c, or 1 if classes is NULL.
+*/
+
+static inline int twinWeight(TwinClasses* classes, int c)
+{
+    return (classes == NULL) ? 1 : classes->weight[c];
+}
+
+/*! \brief a vertex of a twin class.
+
+    \param classes the twin classes, or NULL if twins were not collapsed
+
+    \param c a class, or a vertex if classes is NULL
+
+    \param t which vertex of the class, from 0 to twinWeight(classes, c)-1
+
+    \return the t-th vertex of c, or c if classes is NULL.
+*/
+
+static inline int twinMember(TwinClasses* classes, int c, int t)
+{
+    return (classes == NULL) ? c : classes->members[classes->memberOffsets[c] + t];
+}
+
+TwinClasses* findTwinClasses(CSRGraph* graph);
+
+CSRGraph* collapseTwinClasses(CSRGraph* graph, TwinClasses* classes);
+
+void destroyTwinClasses(TwinClasses* classes);
+
+#endif